@@ -0,0 +1,96 @@
+#include "Benchmark.h"
+
+#include <iomanip>
+#include <iostream>
+
+#ifdef _WIN32
+#    include <Windows.h>
+#    include <psapi.h>
+#else
+#    include <sys/resource.h>
+#endif
+
+namespace bench {
+
+namespace {
+
+constexpr auto minTime = std::chrono::milliseconds(200);
+constexpr auto maxIterations = uint64_t{1} << 30;
+
+auto runCalibrated(const Registration& registration, int64_t arg) -> State {
+    auto iterations = uint64_t{1};
+    while (true) {
+        auto state = State{iterations, arg};
+        registration.function(state);
+        if (state.elapsed() >= minTime || iterations >= maxIterations) return state;
+
+        // estimate the iterations required to reach the minimal time, grow at most 10x
+        auto elapsed = std::max(state.elapsed(), Clock::duration{1});
+        auto estimate = static_cast<uint64_t>(iterations * 1.4 * minTime / elapsed);
+        iterations = std::min(std::max(estimate, iterations + 1), iterations * 10);
+    }
+}
+
+void report(std::ostream& out, const std::string& name, const State& state) {
+    using namespace std::chrono;
+    auto ns = static_cast<double>(duration_cast<nanoseconds>(state.elapsed()).count());
+    auto seconds = ns / 1e9;
+    out << std::left << std::setw(48) << name << std::right;
+    out << std::setw(12) << state.iterations() << " x ";
+    out << std::setw(14) << std::fixed << std::setprecision(1) << ns / state.iterations() << " ns";
+    if (state.bytesProcessed() != 0) {
+        out << "  " << std::setprecision(2) << state.bytesProcessed() / seconds / (1024 * 1024) << " MB/s";
+    }
+    if (state.itemsProcessed() != 0) {
+        out << "  " << std::setprecision(1) << ns / state.itemsProcessed() << " ns/item";
+    }
+    for (const auto& counter : state.counters()) {
+        out << "  " << counter.name << "=" << std::setprecision(0) << counter.value;
+    }
+    out << '\n';
+}
+
+} // namespace
+
+auto registrations() -> Registrations& {
+    static auto result = Registrations{};
+    return result;
+}
+
+auto registerBenchmark(const char* name, Function function, std::initializer_list<int64_t> args) -> bool {
+    registrations().push_back({name, function, args});
+    return true;
+}
+
+auto peakResidentBytes() -> uint64_t {
+#ifdef _WIN32
+    auto counters = PROCESS_MEMORY_COUNTERS{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    auto usage = rusage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#    ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss); // bytes
+#    else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+#    endif
+#endif
+}
+
+auto runAll(const std::string& filter) -> int {
+    for (const auto& registration : registrations()) {
+        auto args = registration.args.empty() ? Args{0} : registration.args;
+        for (auto arg : args) {
+            auto name = std::string(registration.name);
+            if (!registration.args.empty()) name += '/' + std::to_string(arg);
+            if (name.find(filter) == std::string::npos) continue;
+
+            auto state = runCalibrated(registration, arg);
+            report(std::cout, name, state);
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
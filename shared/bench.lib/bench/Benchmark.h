@@ -0,0 +1,117 @@
+#pragma once
+#include <chrono>
+#include <cinttypes>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/// minimal benchmark harness
+///
+/// usage:
+///     static void myBenchmark(bench::State& state) {
+///         auto input = generate(state.arg());
+///         while (state.keepRunning()) {
+///             bench::doNotOptimize(run(input));
+///         }
+///         state.setItemsProcessed(state.iterations() * input.size());
+///     }
+///     BENCHMARK(myBenchmark, 10, 1000);
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+struct Counter {
+    std::string name;
+    double value{};
+};
+using Counters = std::vector<Counter>;
+
+struct State {
+    using This = State;
+
+    State(uint64_t iterations, int64_t arg)
+        : m_maxIterations(iterations)
+        , m_arg(arg) {}
+
+    /// true as long as another iteration should be measured
+    bool keepRunning() {
+        if (m_iterations == 0 && !m_running) resumeTiming();
+        if (m_iterations < m_maxIterations) {
+            m_iterations++;
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    /// exclude setup work inside the measured loop
+    void pauseTiming() {
+        if (!m_running) return;
+        m_elapsed += Clock::now() - m_start;
+        m_running = false;
+    }
+    void resumeTiming() {
+        if (m_running) return;
+        m_start = Clock::now();
+        m_running = true;
+    }
+
+    auto arg() const -> int64_t { return m_arg; }
+    auto iterations() const -> uint64_t { return m_iterations; }
+    auto elapsed() const -> Clock::duration { return m_elapsed; }
+
+    void setItemsProcessed(uint64_t items) { m_items = items; }
+    void setBytesProcessed(uint64_t bytes) { m_bytes = bytes; }
+    void setCounter(std::string name, double value) { m_counters.push_back({std::move(name), value}); }
+
+    auto itemsProcessed() const -> uint64_t { return m_items; }
+    auto bytesProcessed() const -> uint64_t { return m_bytes; }
+    auto counters() const -> const Counters& { return m_counters; }
+
+private:
+    uint64_t m_maxIterations{};
+    uint64_t m_iterations{};
+    int64_t m_arg{};
+    bool m_running{};
+    Clock::time_point m_start{};
+    Clock::duration m_elapsed{};
+    uint64_t m_items{};
+    uint64_t m_bytes{};
+    Counters m_counters{};
+};
+
+using Function = void (*)(State&);
+using Args = std::vector<int64_t>;
+
+struct Registration {
+    const char* name{};
+    Function function{};
+    Args args{};
+};
+using Registrations = std::vector<Registration>;
+
+auto registrations() -> Registrations&;
+auto registerBenchmark(const char* name, Function function, std::initializer_list<int64_t> args = {}) -> bool;
+
+/// peak resident set size of the process in bytes, 0 if unknown
+auto peakResidentBytes() -> uint64_t;
+
+/// runs all benchmarks whose name contains the filter, returns the process exit code
+auto runAll(const std::string& filter = {}) -> int;
+
+/// prevents the compiler from removing the computation of value
+template<class T>
+inline void doNotOptimize(T&& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+} // namespace bench
+
+#define BENCHMARK(function, ...)                                                                                       \
+    [[maybe_unused]] static const auto bench_registered_##function =                                                  \
+        ::bench::registerBenchmark(#function, &function, {__VA_ARGS__})
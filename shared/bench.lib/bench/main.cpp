@@ -0,0 +1,7 @@
+#include "Benchmark.h"
+
+// usage: <benchmarks> [name filter]
+int main(int argc, char** argv) {
+    auto filter = argc > 1 ? std::string(argv[1]) : std::string{};
+    return bench::runAll(filter);
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace meta {
+
+/// bump allocator that releases all its memory at once
+///
+/// note: an arena is not thread safe, each thread activates its own arena with ArenaScope
+struct Arena {
+    using This = Arena;
+    static constexpr size_t defaultChunkSize = 64 * 1024;
+
+    explicit Arena(size_t chunkSize = defaultChunkSize)
+        : m_chunkSize(chunkSize) {}
+    ~Arena() = default;
+
+    // allocations point into the arena
+    Arena(const This&) = delete;
+    Arena(This&&) = delete;
+    auto operator=(const This&) -> This& = delete;
+    auto operator=(This&&) -> This& = delete;
+
+    auto allocate(size_t size, size_t alignment) -> void* {
+        auto aligned = (m_position + alignment - 1) & ~(alignment - 1);
+        if (aligned + size > m_end) {
+            if (size + alignment > m_chunkSize / 4) return allocateSeparate(size, alignment);
+            addChunk(m_chunkSize);
+            aligned = (m_position + alignment - 1) & ~(alignment - 1);
+        }
+        m_position = aligned + size;
+        m_bytesAllocated += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    /// frees all allocations
+    /// note: everything allocated in this arena has to be destroyed before
+    void release() {
+        m_chunks.clear();
+        m_separateChunks.clear();
+        m_position = m_end = 0;
+        m_bytesAllocated = m_bytesReserved = 0;
+    }
+
+    auto bytesAllocated() const -> size_t { return m_bytesAllocated; }
+    auto bytesReserved() const -> size_t { return m_bytesReserved; }
+
+    /// the arena activated for this thread, nullptr if none
+    static auto current() -> Arena* { return t_current; }
+
+private:
+    friend struct ArenaScope;
+    using Chunk = std::unique_ptr<std::byte[]>;
+
+    void addChunk(size_t size) {
+        m_chunks.emplace_back(new std::byte[size]);
+        m_position = reinterpret_cast<uintptr_t>(m_chunks.back().get());
+        m_end = m_position + size;
+        m_bytesReserved += size;
+    }
+
+    // large allocations get their own chunk and keep the current chunk
+    auto allocateSeparate(size_t size, size_t alignment) -> void* {
+        auto& chunk = m_separateChunks.emplace_back(new std::byte[size + alignment]);
+        m_bytesReserved += size + alignment;
+        m_bytesAllocated += size;
+        auto begin = reinterpret_cast<uintptr_t>(chunk.get());
+        return reinterpret_cast<void*>((begin + alignment - 1) & ~(alignment - 1));
+    }
+
+    size_t m_chunkSize{};
+    std::vector<Chunk> m_chunks{};
+    std::vector<Chunk> m_separateChunks{};
+    uintptr_t m_position{};
+    uintptr_t m_end{};
+    size_t m_bytesAllocated{};
+    size_t m_bytesReserved{};
+
+    static inline thread_local Arena* t_current{};
+};
+
+/// activates an arena for the current thread as long as the scope lives
+struct ArenaScope {
+    explicit ArenaScope(Arena* arena)
+        : m_previous(Arena::t_current) {
+        Arena::t_current = arena;
+    }
+    ~ArenaScope() { Arena::t_current = m_previous; }
+
+    ArenaScope(const ArenaScope&) = delete;
+    auto operator=(const ArenaScope&) -> ArenaScope& = delete;
+
+private:
+    Arena* m_previous;
+};
+
+/// allocates from the arena that was active when the allocator was created
+///
+/// * without an active arena the global heap is used
+/// * deallocation within an arena is a no-op, the memory is released with the arena
+/// * copied containers use the arena that is active during the copy
+template<class T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept
+        : arena(Arena::current()) {}
+    explicit ArenaAllocator(Arena* arena) noexcept
+        : arena(arena) {}
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U>& o) noexcept
+        : arena(o.arena) {}
+
+    auto allocate(size_t n) -> T* {
+        if (arena) return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        if (!arena) std::allocator<T>{}.deallocate(p, n);
+    }
+
+    auto select_on_container_copy_construction() const -> ArenaAllocator { return {}; }
+
+    template<class U>
+    bool operator==(const ArenaAllocator<U>& o) const noexcept {
+        return arena == o.arena;
+    }
+    template<class U>
+    bool operator!=(const ArenaAllocator<U>& o) const noexcept {
+        return arena != o.arena;
+    }
+
+    Arena* arena{};
+};
+
+} // namespace meta
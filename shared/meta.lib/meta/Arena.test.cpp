@@ -0,0 +1,46 @@
+#include "Arena.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(arena, alignedBumpAllocation) {
+    auto arena = meta::Arena{1024};
+    auto* a = arena.allocate(3, 1);
+    auto* b = arena.allocate(8, 8);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+    ASSERT_GT(b, a);
+    ASSERT_EQ(arena.bytesAllocated(), 11u);
+    ASSERT_EQ(arena.bytesReserved(), 1024u);
+
+    auto* large = arena.allocate(4096, 16); // separate chunk
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(large) % 16, 0u);
+    auto* c = arena.allocate(8, 8); // continues in the first chunk
+    ASSERT_EQ(static_cast<std::byte*>(c), static_cast<std::byte*>(b) + 8);
+
+    arena.release();
+    ASSERT_EQ(arena.bytesAllocated(), 0u);
+}
+
+TEST(arena, allocatorUsesActiveArena) {
+    using Vec = std::vector<int, meta::ArenaAllocator<int>>;
+    auto arena = meta::Arena{};
+    auto heapVec = Vec{1, 2, 3};
+    ASSERT_EQ(heapVec.get_allocator().arena, nullptr);
+    {
+        auto scope = meta::ArenaScope{&arena};
+        ASSERT_EQ(meta::Arena::current(), &arena);
+
+        auto vec = Vec{};
+        for (auto i = 0; i < 100; i++) vec.push_back(i);
+        ASSERT_EQ(vec.get_allocator().arena, &arena);
+        ASSERT_GE(arena.bytesAllocated(), 100 * sizeof(int));
+
+        auto copy = heapVec; // copies allocate in the active arena
+        ASSERT_EQ(copy.get_allocator().arena, &arena);
+    }
+    ASSERT_EQ(meta::Arena::current(), nullptr);
+
+    auto copy = heapVec;
+    ASSERT_EQ(copy.get_allocator().arena, nullptr);
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace meta {
+
+/// vector like container that never moves its elements
+///
+/// elements are stored in chunks with doubling capacity
+/// * push_back & emplace_back keep all references valid
+/// * moving the container keeps all references valid
+/// * supports incomplete types like std::vector
+/// * new chunks use the allocator of the container
+template<class T, size_t FirstChunkSize = 4, class Allocator = std::allocator<T>>
+struct ChunkedVector {
+    using This = ChunkedVector;
+    using Chunk = std::vector<T, Allocator>;
+    using Chunks = std::vector<Chunk, typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>>;
+
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    static_assert(FirstChunkSize > 0, "chunks may not be empty");
+
+private:
+    template<class V, class C>
+    struct Iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        C* chunks{};
+        size_t chunk{};
+        size_t offset{};
+
+        auto operator*() const -> reference { return (*chunks)[chunk][offset]; }
+        auto operator->() const -> pointer { return &(*chunks)[chunk][offset]; }
+
+        auto operator++() & -> Iterator& {
+            if (++offset == (*chunks)[chunk].size()) {
+                chunk++;
+                offset = 0;
+            }
+            return *this;
+        }
+        auto operator++(int) & -> Iterator {
+            auto r = *this;
+            ++*this;
+            return r;
+        }
+
+        bool operator==(const Iterator& o) const { return chunk == o.chunk && offset == o.offset; }
+        bool operator!=(const Iterator& o) const { return !(*this == o); }
+    };
+
+public:
+    using iterator = Iterator<T, Chunks>;
+    using const_iterator = Iterator<const T, const Chunks>;
+
+    ChunkedVector() = default;
+    ~ChunkedVector() = default;
+
+    ChunkedVector(std::initializer_list<T> il) {
+        for (auto& v : il) push_back(v);
+    }
+
+    // copy has to reserve the full chunk capacity again
+    ChunkedVector(const This& o) {
+        chunks.reserve(o.chunks.size());
+        for (const auto& c : o.chunks) {
+            auto& chunk = addChunk();
+            chunk.insert(chunk.end(), c.begin(), c.end());
+        }
+        count = o.count;
+    }
+    auto operator=(const This& o) -> This& {
+        if (this != &o) *this = This(o);
+        return *this;
+    }
+
+    // move keeps the chunks
+    ChunkedVector(This&& o) noexcept
+        : chunks(std::move(o.chunks))
+        , count(o.count) {
+        o.count = 0;
+    }
+    auto operator=(This&& o) noexcept -> This& {
+        chunks = std::move(o.chunks);
+        count = o.count;
+        o.count = 0;
+        return *this;
+    }
+
+    bool operator==(const This& o) const {
+        if (count != o.count) return false;
+        auto oit = o.begin();
+        for (const auto& v : *this) {
+            if (!(v == *oit)) return false;
+            ++oit;
+        }
+        return true;
+    }
+    bool operator!=(const This& o) const { return !(*this == o); }
+
+    auto size() const noexcept -> size_t { return count; }
+    bool empty() const noexcept { return count == 0; }
+
+    auto operator[](size_t index) & -> reference { return atIndex(chunks, index); }
+    auto operator[](size_t index) const& -> const_reference { return atIndex(chunks, index); }
+
+    auto front() & -> reference { return chunks.front().front(); }
+    auto front() const& -> const_reference { return chunks.front().front(); }
+    auto back() & -> reference { return chunks.back().back(); }
+    auto back() const& -> const_reference { return chunks.back().back(); }
+
+    auto begin() noexcept -> iterator { return {&chunks, 0, 0}; }
+    auto begin() const noexcept -> const_iterator { return {&chunks, 0, 0}; }
+    auto end() noexcept -> iterator { return {&chunks, chunks.size(), 0}; }
+    auto end() const noexcept -> const_iterator { return {&chunks, chunks.size(), 0}; }
+
+    void push_back(const T& v) { emplace_back(v); }
+    void push_back(T&& v) { emplace_back(std::move(v)); }
+
+    template<class... Args>
+    auto emplace_back(Args&&... args) -> reference {
+        if (chunks.empty() || chunks.back().size() == chunkCapacity(chunks.size() - 1)) addChunk();
+        count++;
+        return chunks.back().emplace_back(std::forward<Args>(args)...);
+    }
+
+    void clear() noexcept {
+        chunks.clear();
+        count = 0;
+    }
+
+private:
+    static constexpr auto chunkCapacity(size_t chunk) -> size_t { return FirstChunkSize << chunk; }
+
+    // chunk k starts at index FirstChunkSize * (2^k - 1)
+    template<class C>
+    static auto atIndex(C& chunks, size_t index) -> decltype(chunks[0][0]) {
+        auto chunk = size_t{};
+        for (auto n = index / FirstChunkSize + 1; n > 1; n >>= 1) chunk++;
+        return chunks[chunk][index - FirstChunkSize * ((size_t{1} << chunk) - 1)];
+    }
+
+    auto addChunk() -> Chunk& {
+        auto& chunk = chunks.emplace_back(Allocator(chunks.get_allocator()));
+        chunk.reserve(chunkCapacity(chunks.size() - 1));
+        return chunk;
+    }
+
+private:
+    Chunks chunks{};
+    size_t count{};
+};
+
+} // namespace meta
@@ -0,0 +1,43 @@
+#include "ChunkedVector.h"
+
+#include <gtest/gtest.h>
+
+TEST(chunkedVector, stableReferences) {
+    using Vec = meta::ChunkedVector<int, 2>;
+    auto vec = Vec{};
+    ASSERT_TRUE(vec.empty());
+
+    auto& first = vec.emplace_back(0);
+    auto* firstPtr = &first;
+    for (auto i = 1; i < 100; i++) vec.push_back(i);
+    ASSERT_EQ(vec.size(), 100u);
+    ASSERT_EQ(&vec.front(), firstPtr);
+
+    auto moved = Vec{std::move(vec)};
+    ASSERT_EQ(&moved.front(), firstPtr);
+    ASSERT_TRUE(vec.empty());
+}
+
+TEST(chunkedVector, indexAndIterate) {
+    auto vec = meta::ChunkedVector<int, 3>{};
+    for (auto i = 0; i < 50; i++) vec.push_back(i);
+
+    for (auto i = 0u; i < vec.size(); i++) ASSERT_EQ(vec[i], static_cast<int>(i));
+
+    auto expected = 0;
+    for (auto v : vec) ASSERT_EQ(v, expected++);
+    ASSERT_EQ(expected, 50);
+    ASSERT_EQ(vec.back(), 49);
+}
+
+TEST(chunkedVector, copyKeepsCapacity) {
+    auto vec = meta::ChunkedVector<int>{1, 2, 3};
+    auto copy = vec;
+    ASSERT_EQ(copy, vec);
+
+    auto* firstPtr = &copy.front();
+    copy.push_back(4); // fills the first chunk
+    copy.push_back(5);
+    ASSERT_EQ(&copy.front(), firstPtr);
+    ASSERT_NE(copy, vec);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "CoEnumerator.h"
+
+namespace meta {
+
+/// passes all values of the input through, the observer sees each value before it is yielded
+/// note: allows to inspect a stage of a pipeline without running the stages before it again
+template<class V, class Observer>
+auto coTap(CoEnumerator<V> input, Observer observer) -> CoEnumerator<V> {
+    while (input++) {
+        observer(*input);
+        co_yield input.move();
+    }
+}
+
+} // namespace meta
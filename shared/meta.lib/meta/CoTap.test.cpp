@@ -0,0 +1,24 @@
+#include "CoTap.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+TEST(coTap, observesEachValueOnce) {
+    auto produced = 0;
+    auto source = [&]() -> meta::CoEnumerator<int> {
+        for (auto i = 1; i <= 3; i++) {
+            produced++;
+            co_yield i;
+        }
+    };
+    auto observed = std::vector<int>{};
+    auto tapped = meta::coTap(source(), [&](const int& v) { observed.push_back(v); });
+
+    auto consumed = std::vector<int>{};
+    for (auto v : tapped) consumed.push_back(v);
+
+    EXPECT_EQ(produced, 3);
+    EXPECT_EQ(observed, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(consumed, observed);
+}
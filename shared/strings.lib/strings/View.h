@@ -7,6 +7,7 @@
 
 #include <limits>
 #include <string>
+#include <string_view>
 
 namespace strings {
 
@@ -131,3 +132,15 @@ struct CompareView : View {
 inline auto to_string(const View& v) -> String { return {v.begin(), v.end()}; }
 
 } // namespace strings
+
+namespace std {
+
+// hash is based on the content, like the equality of CompareView
+template<>
+struct hash<strings::CompareView> {
+    auto operator()(const strings::CompareView& v) const noexcept -> size_t {
+        return hash<string_view>{}(string_view(v.data(), v.size()));
+    }
+};
+
+} // namespace std
@@ -233,16 +233,15 @@ struct TypeOf<Context*> {
                 addParametersFromTyped(instance::ParameterSide::left, left.v);
                 addParametersFromTyped(instance::ParameterSide::right, right.v);
                 addParametersFromTyped(instance::ParameterSide::result, results.v);
+                function.updateParameterLayout();
                 return function;
             }());
             auto& function = node->get<instance::Function>();
-
-            auto bodyScope = instance::Scope(&parameterScope);
-            function.body.block = context.v->parse(block.v, &bodyScope);
-            function.body.locals = std::move(bodyScope.locals);
-
             function.parameterScope = std::move(parameterScope.locals);
 
+            context.v->parseBody(block.v, function);
+            context.v->declared(function);
+
             res.v = &function;
         }
     }
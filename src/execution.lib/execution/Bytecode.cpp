@@ -0,0 +1,236 @@
+#include "Bytecode.h"
+
+#include "Machine.h"
+
+#include <unordered_map>
+
+namespace execution {
+namespace bytecode {
+
+namespace {
+
+struct Lowering {
+    Program program{};
+    std::unordered_map<instance::TypedView, Offset> offsets{};
+    std::vector<Destruct> constructed{};
+
+    void parameters(const instance::Function& function) {
+        for (auto* parameter : function.parameters) {
+            offsets[&parameter->typed] = program.frameSize;
+            if (Machine::ownsArgument(*parameter)) construct(program.frameSize, parameter->typed.type);
+            program.frameSize += static_cast<Offset>(Machine::argumentSize(*parameter));
+        }
+    }
+
+    // note: intrinsics work on the frame of the parent context, for a function body these are the arguments
+    void block(const parser::Block& block, Offset parentBase) {
+        auto blockBase = program.frameSize;
+        for (const auto& node : block.nodes) {
+            node.visitSome([&](const parser::VariableInit& var) {
+                const auto& type = var.variable->typed.type;
+                program.frameSize = static_cast<Offset>(alignOffset(program.frameSize, type->alignment));
+                offsets[&var.variable->typed] = program.frameSize;
+                program.frameSize += static_cast<Offset>(Machine::typeExpressionSize(type));
+            });
+        }
+        for (const auto& node : block.nodes) statement(node, parentBase, blockBase);
+    }
+
+    void finish() {
+        emit(Op::ret, 0);
+        program.destructs.assign(constructed.rbegin(), constructed.rend());
+    }
+
+    void construct(Offset offset, parser::TypeView type) {
+        if (!type->traits[parser::TypeTrait::triviallyDestructible] && type->destructFunc)
+            constructed.push_back(Destruct{offset, type});
+    }
+
+    void statement(const parser::Node& node, Offset parentBase, Offset blockBase) {
+        node.visit(
+            [&](const parser::Block& nested) { block(nested, blockBase); },
+            [&](const parser::Call& call) { callSite(call, {}); },
+            [&](const parser::IntrinsicCall& intrinsic) {
+                program.intrinsics.push_back(IntrinsicSite{intrinsic.exec, parentBase});
+                emit(Op::callIntrinsic, static_cast<Index>(program.intrinsics.size() - 1));
+            },
+            [&](const parser::VariableInit& var) {
+                if (var.nodes.size() != 1) return;
+                auto offset = offsetOf(&var.variable->typed);
+                value(var.nodes.front(), StoreTarget::frame, offset);
+                construct(offset, var.variable->typed.type);
+            },
+            [&](const parser::NameTypeValueTuple& typed) {
+                for (const auto& entry : typed.tuple) {
+                    if (entry.value) statement(entry.value.value(), parentBase, blockBase);
+                }
+            },
+            [&](const auto&) {});
+    }
+
+    /// where a call writes its result to
+    struct Result {
+        bool valid{};
+        StoreKind kind{}; // slotAddress or outerCalleeAddress
+        Offset offset{};
+    };
+
+    void callSite(const parser::Call& call, Result result) {
+        const auto& function = *call.function;
+        program.calls.push_back(CallSite{&function});
+        auto index = static_cast<Index>(program.calls.size() - 1);
+
+        emit(Op::enter, index);
+        auto memory = Offset{};
+        for (auto* parameter : function.parameters) {
+            if (result.valid && parameter->side == instance::ParameterSide::result) {
+                auto store = Store{};
+                store.kind = result.kind;
+                store.target = StoreTarget::callee;
+                store.destination = memory;
+                store.source = result.offset;
+                emitStore(store);
+            }
+            else if (Machine::isDiscardedResult(call, *parameter)) {
+                auto store = Store{};
+                store.kind = StoreKind::slotAddress;
+                store.target = StoreTarget::callee;
+                store.destination = memory;
+                store.source = discardSlot(parameter->typed.type);
+                emitStore(store);
+            }
+            else {
+                argument(call, *parameter, memory);
+            }
+            memory += static_cast<Offset>(Machine::argumentSize(*parameter));
+        }
+        emit(Op::invoke, index);
+    }
+
+    void argument(const parser::Call& call, const instance::Parameter& parameter, Offset destination) {
+        using namespace instance;
+        const auto* nodes = &parameter.init;
+        for (const auto& assign : call.arguments) {
+            if (assign.parameter == &parameter) {
+                nodes = &assign.values; // note: the first assignment wins, as in the Machine
+                break;
+            }
+        }
+        if (parameter.flags.any(ParameterFlag::splatted)) return fail("splatted arguments");
+        if (parameter.flags.any(ParameterFlag::assignable)) {
+            if (nodes->size() != 1) return fail("assignable arguments without a single value");
+            auto store = Store{};
+            store.target = StoreTarget::callee;
+            store.destination = destination;
+            nodes->front().visit(
+                [&](const parser::VariableReference& var) { slotAddress(store, &var.variable->typed); },
+                [&](const parser::ParameterReference& param) { slotAddress(store, &param.parameter->typed); },
+                [&](const parser::Value& value) {
+                    store.kind = StoreKind::valueAddress;
+                    store.constant = value.data();
+                },
+                [&](const auto&) { fail("addresses of expressions"); });
+            emitStore(store);
+            return;
+        }
+        for (const auto& node : *nodes) value(node, StoreTarget::callee, destination);
+    }
+
+    void slotAddress(Store& store, instance::TypedView typed) {
+        store.kind = StoreKind::slotAddress;
+        store.source = offsetOf(typed);
+    }
+
+    // note: variables of other frames, like globals, are not reachable from a lowered program
+    auto offsetOf(instance::TypedView typed) -> Offset {
+        auto it = offsets.find(typed);
+        if (it == offsets.end()) {
+            fail("references outside of the frame");
+            return {};
+        }
+        return it->second;
+    }
+
+    auto discardSlot(parser::TypeView type) -> Offset {
+        program.frameSize = static_cast<Offset>(alignOffset(program.frameSize, type->alignment));
+        auto offset = program.frameSize;
+        program.frameSize += static_cast<Offset>(Machine::typeExpressionSize(type));
+        return offset;
+    }
+
+    void fail(const char* reason) {
+        if (!program.unsupported) program.unsupported = reason;
+    }
+
+    void value(const parser::Node& node, StoreTarget target, Offset destination) {
+        auto store = Store{};
+        store.target = target;
+        store.destination = destination;
+        auto copySlot = [&](const instance::Typed& typed) {
+            store.kind = StoreKind::copySlot;
+            store.source = offsetOf(&typed);
+            store.type = typed.type;
+            emitStore(store);
+        };
+        node.visit(
+            [&](const parser::Call& call) {
+                auto kind = target == StoreTarget::frame ? StoreKind::slotAddress : StoreKind::outerCalleeAddress;
+                callSite(call, Result{true, kind, destination});
+            },
+            [&](const parser::ParameterReference& param) { copySlot(param.parameter->typed); },
+            [&](const parser::VariableReference& var) { copySlot(var.variable->typed); },
+            [&](const parser::NameTypeValueReference& ref) {
+                if (ref.nameTypeValue && ref.nameTypeValue->value)
+                    value(ref.nameTypeValue->value.value(), target, destination);
+                else
+                    fail("references to names without a value");
+            },
+            [&](const parser::ModuleReference&) {},
+            [&](const parser::NameTypeValueTuple& tuple) {
+                store.kind = StoreKind::copyTuple;
+                store.constant = &tuple;
+                emitStore(store);
+            },
+            [&](const parser::Value& value) {
+                store.kind = StoreKind::copyValue;
+                store.type = value.type();
+                store.constant = value.data();
+                emitStore(store);
+            },
+            [&](const auto&) { fail("values of expressions"); });
+    }
+
+    void emitStore(const Store& store) {
+        program.stores.push_back(store);
+        emit(Op::store, static_cast<Index>(program.stores.size() - 1));
+    }
+
+    void emit(Op op, Index index) { program.instructions.push_back(Instruction{op, index}); }
+};
+
+} // namespace
+
+auto compileFunction(const instance::Function& function) -> ProgramPtr {
+    auto lowering = Lowering{};
+    lowering.parameters(function);
+    lowering.block(function.body.block, 0);
+    lowering.finish();
+    return std::make_shared<const Program>(std::move(lowering.program));
+}
+
+auto compileBlock(const parser::Block& block) -> ProgramPtr {
+    auto lowering = Lowering{};
+    lowering.block(block, 0);
+    lowering.finish();
+    return std::make_shared<const Program>(std::move(lowering.program));
+}
+
+auto compileCall(const parser::Call& call) -> ProgramPtr {
+    auto lowering = Lowering{};
+    lowering.callSite(call, {});
+    lowering.finish();
+    return std::make_shared<const Program>(std::move(lowering.program));
+}
+
+} // namespace bytecode
+} // namespace execution
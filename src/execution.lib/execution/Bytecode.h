@@ -0,0 +1,102 @@
+#pragma once
+#include "parser/Tree.h"
+
+#include "instance/Views.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace execution {
+
+namespace bytecode {
+
+using Offset = uint32_t;
+using Index = uint32_t;
+
+enum class Op : uint8_t {
+    callIntrinsic, // IntrinsicSite
+    enter, // allocates the frame of the CallSite as the next callee
+    store, // Store into the own frame or the next callee
+    invoke, // runs the next callee of the CallSite
+    ret,
+};
+
+struct Instruction {
+    Op op{};
+    Index index{};
+};
+
+struct IntrinsicSite {
+    parser::IntrinsicCall::Exec exec{};
+    Offset memory{}; // the arguments the intrinsic works on
+};
+
+enum class StoreKind : uint8_t {
+    copyValue, // clone a constant value
+    copySlot, // clone a value of the own frame
+    valueAddress, // pointer to a constant value
+    slotAddress, // pointer into the own frame
+    outerCalleeAddress, // pointer into the callee that was entered before the next callee
+    copyTuple, // placement copy of a tuple
+};
+
+enum class StoreTarget : uint8_t {
+    frame, // the own frame
+    callee, // the frame of the next callee
+};
+
+/// writes one value into a frame
+struct Store {
+    StoreKind kind{};
+    StoreTarget target{};
+    Offset destination{};
+    Offset source{}; // copySlot, slotAddress, outerCalleeAddress
+    parser::TypeView type{}; // copyValue, copySlot
+    const void* constant{}; // copyValue, valueAddress, copyTuple
+};
+
+struct CallSite {
+    instance::FunctionView function{};
+};
+
+/// value in the frame, that is destructed when the program returns
+struct Destruct {
+    Offset offset{};
+    parser::TypeView type{};
+};
+
+/// a function block lowered for the VM
+///
+/// * all variables of nested blocks and the arguments share one frame, addressed by byte offsets
+/// * the frame starts with the arguments in parameter order
+/// * variables are aligned to their type, arguments stay packed as the intrinsics expect them
+/// * instructions reference the tables of the program by index
+/// * a call enters the callee frame, stores the arguments and invokes it, nested calls enter in between
+/// * owned arguments and variables are destructed on return, nested blocks do not end earlier
+/// * results of statement calls are written to the own frame and dropped
+/// note: a program with an unsupported reason must not run
+struct Program {
+    const char* unsupported{}; // kind of the first node the lowering cannot handle
+    Offset frameSize{};
+    std::vector<Instruction> instructions{}; // terminated by ret
+    std::vector<IntrinsicSite> intrinsics{};
+    std::vector<CallSite> calls{};
+    std::vector<Store> stores{};
+    std::vector<Destruct> destructs{}; // reverse order of construction
+};
+using ProgramPtr = std::shared_ptr<const Program>;
+
+/// lowers the body of the function
+/// note: the program points into the body and the parameters, it is invalid after they change
+auto compileFunction(const instance::Function& function) -> ProgramPtr;
+
+/// lowers a block that runs without arguments
+auto compileBlock(const parser::Block& block) -> ProgramPtr;
+
+/// lowers a single call, the arguments cannot refer to any frame
+auto compileCall(const parser::Call& call) -> ProgramPtr;
+
+} // namespace bytecode
+
+} // namespace execution
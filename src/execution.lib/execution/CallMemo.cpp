@@ -0,0 +1,97 @@
+#include "CallMemo.h"
+
+namespace execution {
+
+namespace {
+
+auto combineHash(size_t seed, size_t hash) -> size_t { return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2)); }
+
+bool isResult(const parser::ArgumentAssignment& assign) {
+    return assign.parameter->side == instance::ParameterSide::result;
+}
+
+// note: user functions only carry the compiletime flag, their bodies might have any side effect
+bool isPure(const instance::Function& function) {
+    using instance::FunctionFlag;
+    return function.body.intrinsic && function.flags.any(FunctionFlag::compiletime)
+        && !function.flags.any(FunctionFlag::compiletime_sideeffects);
+}
+
+// note: a pure call without results has nothing to remember
+bool hasResults(const instance::Function& function) {
+    for (const auto* parameter : function.parameters) {
+        if (parameter->side == instance::ParameterSide::result) return true;
+    }
+    return false;
+}
+
+// compares the key arguments with the arguments of a call that may contain result parameters
+bool sameArguments(const parser::ArgumentAssignments& key, const parser::ArgumentAssignments& arguments) {
+    auto it = key.begin();
+    for (const auto& assign : arguments) {
+        if (isResult(assign)) continue;
+        if (it == key.end() || *it != assign) return false;
+        ++it;
+    }
+    return it == key.end();
+}
+
+} // namespace
+
+auto CallMemo::hashCall(const parser::Call& call) -> meta::Optional<Hash> {
+    if (!isPure(*call.function) || !hasResults(*call.function)) return {};
+    auto hash = Hash{};
+    for (const auto& assign : call.arguments) {
+        if (isResult(assign)) continue;
+        hash = combineHash(hash, std::hash<const void*>{}(assign.parameter));
+        for (const auto& node : assign.values) {
+            if (!node.holds<parser::Value>()) return {};
+            const auto& value = node.get<parser::Value>();
+            auto type = value.type();
+            if (!type || !type->hashFunc) return {};
+            hash = combineHash(hash, type->hashFunc(value.data()));
+        }
+    }
+    return hash;
+}
+
+auto CallMemo::lookup(const parser::Call& call, Hash hash) -> const parser::OptNode* {
+    auto functionIt = m_byFunction.find(call.function);
+    if (functionIt != m_byFunction.end()) {
+        auto [begin, end] = functionIt->second.entries.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (sameArguments(it->second.arguments, call.arguments)) {
+                m_stats.hits++;
+                return &it->second.result;
+            }
+        }
+    }
+    m_stats.misses++;
+    return nullptr;
+}
+
+void CallMemo::store(parser::Call&& call, Hash hash, parser::OptNode result) {
+    auto entry = Entry{};
+    for (auto& assign : call.arguments) {
+        if (!isResult(assign)) entry.arguments.push_back(std::move(assign));
+    }
+    entry.result = std::move(result);
+
+    auto& functionEntries = m_byFunction[call.function];
+    if (functionEntries.entries.empty()) functionEntries.name = call.function->name;
+    functionEntries.entries.emplace(hash, std::move(entry));
+}
+
+void CallMemo::invalidate(const instance::Function& function) {
+    for (auto it = m_byFunction.begin(); it != m_byFunction.end();) {
+        if (it->first == &function || it->second.name == function.name) {
+            m_stats.invalidations += it->second.entries.size();
+            it = m_byFunction.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+} // namespace execution
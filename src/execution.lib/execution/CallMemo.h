@@ -0,0 +1,64 @@
+#pragma once
+#include "parser/Tree.h"
+
+#include "instance/Function.h"
+
+#include "meta/Optional.h"
+
+#include <unordered_map>
+
+namespace execution {
+
+/// counters to judge the memoisation
+struct CallMemoStats {
+    uint64_t hits{};
+    uint64_t misses{};
+    uint64_t invalidations{}; // number of dropped entries
+
+    auto hitRate() const -> double {
+        auto lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+/// remembers the results of pure compile time calls
+///
+/// * pure functions run at compile time without side effects and their body is a single intrinsic
+/// * only calls of pure functions with results, where all arguments are values with a hashFunc, are memoised
+/// * result parameters are not part of the key
+/// note: the compiler only stores calls whose results it extracts, a hit returns them without running the call
+struct CallMemo {
+    using This = CallMemo;
+    using Hash = size_t;
+
+    /// structural hash of the arguments, empty if the call cannot be memoised
+    static auto hashCall(const parser::Call& call) -> meta::Optional<Hash>;
+
+    /// the cached result or nullptr on a miss
+    auto lookup(const parser::Call& call, Hash hash) -> const parser::OptNode*;
+
+    /// takes the arguments of the executed call as key
+    void store(parser::Call&& call, Hash hash, parser::OptNode result);
+
+    /// drops all entries of the function and all functions with the same name
+    void invalidate(const instance::Function& function);
+
+    auto stats() const -> const CallMemoStats& { return m_stats; }
+
+private:
+    struct Entry {
+        parser::ArgumentAssignments arguments; // without result parameters
+        parser::OptNode result;
+    };
+    using EntriesByHash = std::unordered_multimap<Hash, Entry>;
+    struct FunctionEntries {
+        instance::Name name; // note: the function might be gone on invalidation
+        EntriesByHash entries;
+    };
+    using EntriesByFunction = std::unordered_map<instance::FunctionView, FunctionEntries>;
+
+    EntriesByFunction m_byFunction{};
+    CallMemoStats m_stats{};
+};
+
+} // namespace execution
@@ -0,0 +1,119 @@
+#include "execution/CallMemo.h"
+
+#include "instance/Function.builder.h"
+#include "instance/Scope.builder.h"
+#include "instance/Type.builder.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+auto callWith(const instance::Function& fun, parser::TypeView type, uint64_t v) -> parser::Call {
+    auto value = parser::Value{type};
+    value.set<uint64_t>() = v;
+    auto assign = parser::ArgumentAssignment{};
+    assign.parameter = fun.parameters.front();
+    assign.values.emplace_back(std::move(value));
+
+    auto call = parser::Call{};
+    call.function = &fun;
+    call.arguments.push_back(std::move(assign));
+    return call;
+}
+
+auto resultNode(parser::TypeView type, uint64_t v) -> parser::OptNode {
+    auto value = parser::Value{type};
+    value.set<uint64_t>() = v;
+    return parser::Node{std::move(value)};
+}
+
+void noop(uint8_t*, intrinsic::Context*) {}
+
+} // namespace
+
+TEST(callMemo, pureCalls) {
+    auto scope = instance::Scope{};
+    instance::buildScope(
+        scope,
+        instance::typeModT<uint64_t>("u64"),
+        instance::fun("pure").compiletime().rawIntrinsic(&noop).params(
+            instance::param("v").right().type(parser::type("u64")),
+            instance::param("r").result().type(parser::type("u64"))),
+        instance::fun("noResult").compiletime().rawIntrinsic(&noop).params(
+            instance::param("v").right().type(parser::type("u64"))),
+        instance::fun("effect").compiletime_sideeffects().params(instance::param("v").right().type(parser::type("u64"))));
+    auto type = parser::type("u64").build(scope);
+    const auto& pure = instance::lookupA<instance::Function>(scope, instance::NameView{"pure"});
+    const auto& noResult = instance::lookupA<instance::Function>(scope, instance::NameView{"noResult"});
+    const auto& effect = instance::lookupA<instance::Function>(scope, instance::NameView{"effect"});
+
+    ASSERT_FALSE(execution::CallMemo::hashCall(callWith(effect, type, 1)));
+    ASSERT_FALSE(execution::CallMemo::hashCall(callWith(noResult, type, 1)));
+
+    auto memo = execution::CallMemo{};
+    auto call = callWith(pure, type, 1);
+    auto hash = execution::CallMemo::hashCall(call);
+    ASSERT_TRUE(hash);
+    ASSERT_EQ(hash.value(), execution::CallMemo::hashCall(callWith(pure, type, 1)).value());
+
+    ASSERT_EQ(memo.lookup(call, hash.value()), nullptr);
+    memo.store(std::move(call), hash.value(), resultNode(type, 42));
+
+    auto* result = memo.lookup(callWith(pure, type, 1), hash.value());
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(*result, resultNode(type, 42));
+
+    auto other = callWith(pure, type, 2);
+    EXPECT_EQ(memo.lookup(other, execution::CallMemo::hashCall(other).value()), nullptr);
+
+    EXPECT_EQ(memo.stats().hits, 1u);
+    EXPECT_EQ(memo.stats().misses, 2u);
+    EXPECT_DOUBLE_EQ(memo.stats().hitRate(), 1.0 / 3.0);
+}
+
+TEST(callMemo, redeclareInvalidates) {
+    auto scope = instance::Scope{};
+    instance::buildScope(
+        scope,
+        instance::typeModT<uint64_t>("u64"),
+        instance::fun("pure").compiletime().rawIntrinsic(&noop).params(
+            instance::param("v").right().type(parser::type("u64")),
+            instance::param("r").result().type(parser::type("u64"))));
+    auto type = parser::type("u64").build(scope);
+    const auto& pure = instance::lookupA<instance::Function>(scope, instance::NameView{"pure"});
+
+    auto memo = execution::CallMemo{};
+    auto hash = execution::CallMemo::hashCall(callWith(pure, type, 1)).value();
+    memo.store(callWith(pure, type, 1), hash, resultNode(type, 42));
+    ASSERT_NE(memo.lookup(callWith(pure, type, 1), hash), nullptr);
+
+    auto redeclared = instance::Function{};
+    redeclared.name = instance::Name{"pure"};
+    memo.invalidate(redeclared);
+
+    EXPECT_EQ(memo.lookup(callWith(pure, type, 1), hash), nullptr);
+    EXPECT_EQ(memo.stats().invalidations, 1u);
+}
+
+TEST(callMemo, userFunctionsAreNotPure) {
+    auto scope = instance::Scope{};
+    instance::buildScope(
+        scope,
+        instance::typeModT<uint64_t>("u64"),
+        instance::fun("effect").compiletime_sideeffects().params(instance::param("v").right().type(parser::type("u64"))));
+    auto type = parser::type("u64").build(scope);
+    const auto& effect = instance::lookupA<instance::Function>(scope, instance::NameView{"effect"});
+    auto user = instance::fun("user")
+                    .compiletime()
+                    .params(
+                        instance::param("v").right().type(parser::type("u64")),
+                        instance::param("r").result().type(parser::type("u64")))
+                    .build(scope);
+
+    // declared functions only carry the compiletime flag, whatever their body does
+    user.body.block.nodes.emplace_back(callWith(effect, type, 1));
+    user.body.updateIntrinsic();
+
+    EXPECT_FALSE(execution::CallMemo::hashCall(callWith(user, type, 1)));
+    EXPECT_FALSE(execution::CallMemo::hashCall(callWith(user, type, 1)));
+}
@@ -1,7 +1,84 @@
 #include "Frame.h"
 
+#include "Machine.h"
+
+#include <unordered_map>
+
 namespace execution {
 
-// empty
+namespace {
+
+using parser::FrameSlot;
+
+struct SlotResolver {
+    using Level = uint32_t;
+
+    Level level{}; // 0 are the arguments
+    std::unordered_map<instance::TypedView, FrameSlot> declared{}; // depth is the level of the declaration
+
+    void parameters(const instance::Function& function) {
+        auto offset = uint32_t{};
+        for (auto* parameter : function.parameters) {
+            declared[&parameter->typed] = FrameSlot{level, offset};
+            offset += static_cast<uint32_t>(Machine::argumentSize(*parameter));
+        }
+    }
+
+    void block(parser::Block& block) {
+        level++;
+        auto offset = uint32_t{};
+        for (const auto& node : block.nodes) {
+            node.visitSome([&](const parser::VariableInit& var) {
+                const auto& type = var.variable->typed.type;
+                offset = static_cast<uint32_t>(alignOffset(offset, type->alignment));
+                declared[&var.variable->typed] = FrameSlot{level, offset};
+                offset += static_cast<uint32_t>(Machine::typeExpressionSize(type));
+            });
+        }
+        block.frameSize = offset;
+        nodes(block.nodes);
+        level--;
+    }
+
+    void nodes(parser::Nodes& nodes) {
+        for (auto& node : nodes) this->node(node);
+    }
+
+    void node(parser::Node& node) {
+        node.visitSome(
+            [&](parser::Block& nested) { block(nested); },
+            [&](parser::Call& call) {
+                for (auto& assign : call.arguments) nodes(assign.values);
+            },
+            [&](parser::ParameterReference& ref) { ref.slot = resolve(&ref.parameter->typed); },
+            [&](parser::VariableReference& ref) { ref.slot = resolve(&ref.variable->typed); },
+            [&](parser::VariableInit& var) {
+                var.slot = resolve(&var.variable->typed);
+                nodes(var.nodes);
+            },
+            [&](parser::NameTypeValueTuple& typed) {
+                for (auto& entry : typed.tuple) {
+                    if (entry.value) this->node(entry.value.value());
+                }
+            });
+    }
+
+    // note: references to other functions stay unresolved
+    auto resolve(instance::TypedView typed) const -> FrameSlot {
+        auto it = declared.find(typed);
+        if (it == declared.end()) return {};
+        return FrameSlot{level - it->second.depth, it->second.offset};
+    }
+};
+
+} // namespace
+
+void resolveSlots(instance::Function& function) {
+    auto resolver = SlotResolver{};
+    resolver.parameters(function);
+    resolver.block(function.body.block);
+}
+
+void resolveSlots(parser::Block& block) { SlotResolver{}.block(block); }
 
 } // namespace execution
@@ -0,0 +1,83 @@
+#include "execution/Frame.h"
+
+#include "instance/Function.builder.h"
+#include "instance/Scope.builder.h"
+#include "instance/Type.builder.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+template<size_t N>
+auto variable(instance::Function& function, const char (&name)[N], parser::TypeView type) -> instance::VariableView {
+    auto variable = instance::Variable{};
+    variable.typed.name = instance::Name{name};
+    variable.typed.type = type;
+    return &function.body.locals.emplace(std::move(variable))->get<instance::Variable>();
+}
+
+auto init(instance::VariableView variable, parser::Node node) -> parser::VariableInit {
+    auto init = parser::VariableInit{};
+    init.variable = variable;
+    init.nodes.push_back(std::move(node));
+    return init;
+}
+
+} // namespace
+
+TEST(frame, resolveSlots) {
+    auto scope = instance::Scope{};
+    instance::buildScope(scope, instance::typeModT<uint64_t>("u64"));
+    auto u64 = parser::type("u64").build(scope);
+    auto function = instance::fun("f")
+                        .params(
+                            instance::param("a").right().type(parser::type("u64")),
+                            instance::param("b").right().type(parser::type("u64")))
+                        .build(scope);
+    auto* b = function.parameters[1];
+    auto* x = variable(function, "x", u64);
+    auto* y = variable(function, "y", u64);
+    auto* z = variable(function, "z", u64);
+
+    auto& nodes = function.body.block.nodes;
+    nodes.push_back(init(x, parser::ParameterReference{b}));
+    nodes.push_back(init(y, parser::VariableReference{x}));
+    auto nested = parser::Block{};
+    nested.nodes.push_back(init(z, parser::VariableReference{y}));
+    nested.nodes.push_back(parser::ParameterReference{b});
+    nodes.push_back(std::move(nested));
+
+    execution::resolveSlots(function);
+
+    using Slot = parser::FrameSlot;
+    auto expectSlot = [](const Slot& slot, uint32_t depth, uint32_t offset) {
+        EXPECT_EQ(slot.depth, depth);
+        EXPECT_EQ(slot.offset, offset);
+    };
+    EXPECT_EQ(function.body.block.frameSize, 16u);
+    const auto& xInit = nodes[0].get<parser::VariableInit>();
+    expectSlot(xInit.slot, 0, 0);
+    expectSlot(xInit.nodes[0].get<parser::ParameterReference>().slot, 1, 8);
+    const auto& yInit = nodes[1].get<parser::VariableInit>();
+    expectSlot(yInit.slot, 0, 8);
+    expectSlot(yInit.nodes[0].get<parser::VariableReference>().slot, 0, 0);
+
+    const auto& block = nodes[2].get<parser::Block>();
+    EXPECT_EQ(block.frameSize, 8u);
+    const auto& zInit = block.nodes[0].get<parser::VariableInit>();
+    expectSlot(zInit.slot, 0, 0);
+    expectSlot(zInit.nodes[0].get<parser::VariableReference>().slot, 1, 8);
+    expectSlot(block.nodes[1].get<parser::ParameterReference>().slot, 2, 8);
+}
+
+TEST(frame, foreignReferencesStayUnresolved) {
+    auto scope = instance::Scope{};
+    instance::buildScope(scope, instance::typeModT<uint64_t>("u64"));
+    auto other = instance::fun("other").params(instance::param("a").right().type(parser::type("u64"))).build(scope);
+
+    auto block = parser::Block{};
+    block.nodes.push_back(parser::ParameterReference{other.parameters[0]});
+    execution::resolveSlots(block);
+
+    EXPECT_FALSE(block.nodes[0].get<parser::ParameterReference>().slot.resolved());
+}
@@ -0,0 +1,213 @@
+#include "execution/Machine.h"
+#include "execution/VM.h"
+
+#include "instance/Function.builder.h"
+#include "instance/Scope.builder.h"
+#include "instance/Type.builder.h"
+
+#include "parser/Type.builder.h"
+
+#include "bench/Benchmark.h"
+
+#include <deque>
+#include <string>
+
+namespace {
+
+auto makeName(const std::string& text) -> instance::Name { return {text.data(), text.data() + text.size()}; }
+
+uint64_t g_sum{};
+
+template<int Count>
+void sumIntrinsic(uint8_t* memory, intrinsic::Context*) {
+    auto* args = reinterpret_cast<const uint64_t*>(memory);
+    for (auto i = 0; i < Count; i++) g_sum += args[i];
+}
+
+constexpr auto parameterCount = 8;
+
+/// function with parameterCount right parameters of type, that sums them up
+auto makeSum(parser::TypeView type) -> instance::Function {
+    auto fun = instance::Function{};
+    fun.name = makeName("sum");
+    for (auto p = 0; p < parameterCount; p++) {
+        auto param = instance::Parameter{};
+        param.typed.name = makeName("p" + std::to_string(p));
+        param.typed.type = type;
+        param.side = instance::ParameterSide::right;
+        auto entry = fun.parameterScope.emplace(std::move(param));
+        fun.parameters.push_back(&entry->get<instance::Parameter>());
+    }
+    fun.updateParameterLayout();
+    fun.body.block.nodes.emplace_back(parser::IntrinsicCall{&sumIntrinsic<parameterCount>});
+    fun.body.updateIntrinsic();
+    return fun;
+}
+
+auto makeCall(const instance::Function& fun, parser::TypeView type) -> parser::Call {
+    auto call = parser::Call{};
+    call.function = &fun;
+    for (auto* param : fun.parameters) {
+        auto value = parser::Value{type};
+        value.set<uint64_t>() = call.arguments.size() + 1;
+        auto assign = parser::ArgumentAssignment{};
+        assign.parameter = param;
+        assign.values.emplace_back(std::move(value));
+        call.arguments.push_back(std::move(assign));
+    }
+    return call;
+}
+
+void runCalls(bench::State& state, parser::TypeView type) {
+    auto fun = makeSum(type);
+    auto call = makeCall(fun, type);
+
+    auto compiler = execution::Compiler{};
+    auto context = execution::Context{};
+    context.compiler = &compiler;
+
+    while (state.keepRunning()) {
+        for (auto i = 0; i < state.arg(); i++) execution::Machine::runCall(call, context);
+    }
+    bench::doNotOptimize(g_sum);
+    state.setItemsProcessed(state.iterations() * state.arg() * parameterCount);
+}
+
+/// pass u64 arguments, the adapter marks the type trivially copyable
+void passPrimitiveArguments(bench::State& state) {
+    auto scope = instance::Scope{};
+    instance::buildScope(scope, instance::typeModT<uint64_t>("u64"));
+    runCalls(state, parser::type("u64").build(scope));
+}
+BENCHMARK(passPrimitiveArguments, 1, 64);
+
+/// same as above but every argument is copied through the type functions
+void passOpaqueArguments(bench::State& state) {
+    auto scope = instance::Scope{};
+    instance::buildScope(scope, instance::typeModT<uint64_t>("u64"));
+    auto opaque = *parser::type("u64").build(scope);
+    opaque.traits = {};
+    runCalls(state, &opaque);
+}
+BENCHMARK(passOpaqueArguments, 1, 64);
+
+/// chain of functions, each stores its argument in a variable and passes it down to the next
+/// note: without branches the language has no terminating recursion, the chain unrolls it
+struct CallChain {
+    std::deque<instance::Function> functions{};
+
+    CallChain(parser::TypeView type, int depth) {
+        auto& last = functions.emplace_back();
+        last.name = makeName("leaf");
+        addParameter(last, type);
+        last.body.block.nodes.emplace_back(parser::IntrinsicCall{&sumIntrinsic<1>});
+        execution::prepareBody(last);
+
+        for (auto d = 1; d < depth; d++) {
+            auto& callee = functions.back();
+            auto& fun = functions.emplace_back();
+            fun.name = makeName("level" + std::to_string(d));
+            auto* param = addParameter(fun, type);
+
+            auto variable = instance::Variable{};
+            variable.typed.name = makeName("v");
+            variable.typed.type = type;
+            auto* var = &fun.body.locals.emplace(std::move(variable))->get<instance::Variable>();
+
+            auto init = parser::VariableInit{};
+            init.variable = var;
+            init.nodes.emplace_back(parser::ParameterReference{param});
+            fun.body.block.nodes.emplace_back(std::move(init));
+            fun.body.block.nodes.emplace_back(callWith(callee, parser::VariableReference{var}));
+            execution::prepareBody(fun);
+        }
+    }
+
+    static auto addParameter(instance::Function& fun, parser::TypeView type) -> instance::ParameterView {
+        auto param = instance::Parameter{};
+        param.typed.name = makeName("p");
+        param.typed.type = type;
+        param.side = instance::ParameterSide::right;
+        auto entry = fun.parameterScope.emplace(std::move(param));
+        fun.parameters.push_back(&entry->get<instance::Parameter>());
+        fun.updateParameterLayout();
+        return fun.parameters.back();
+    }
+
+    static auto callWith(const instance::Function& fun, parser::Node argument) -> parser::Call {
+        auto assign = parser::ArgumentAssignment{};
+        assign.parameter = fun.parameters.front();
+        assign.values.emplace_back(std::move(argument));
+        auto call = parser::Call{};
+        call.function = &fun;
+        call.arguments.push_back(std::move(assign));
+        return call;
+    }
+};
+
+template<class Engine>
+void runChain(bench::State& state) {
+    auto scope = instance::Scope{};
+    instance::buildScope(scope, instance::typeModT<uint64_t>("u64"));
+    auto type = parser::type("u64").build(scope);
+    auto chain = CallChain{type, static_cast<int>(state.arg())};
+
+    auto value = parser::Value{type};
+    value.set<uint64_t>() = 1;
+    auto call = CallChain::callWith(chain.functions.back(), std::move(value));
+
+    auto compiler = execution::Compiler{};
+    auto context = execution::Context{};
+    context.compiler = &compiler;
+
+    while (state.keepRunning()) Engine::runCall(call, context);
+    bench::doNotOptimize(g_sum);
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+
+/// nested user function calls with parameter and variable accesses through the frame slots
+void nestedCallsMachine(bench::State& state) { runChain<execution::Machine>(state); }
+BENCHMARK(nestedCallsMachine, 8, 64);
+
+/// same calls lowered for the VM
+void nestedCallsVM(bench::State& state) { runChain<execution::VM>(state); }
+BENCHMARK(nestedCallsVM, 8, 64);
+
+void sayIntrinsic(uint8_t* memory, intrinsic::Context*) {
+    g_sum += std::launder(reinterpret_cast<const std::string*>(memory))->size();
+}
+
+template<class Engine>
+void runSay(bench::State& state) {
+    auto scope = instance::Scope{};
+    instance::buildScope(
+        scope,
+        instance::typeModT<std::string>("text"),
+        instance::fun("say").params(instance::param("t").right().type(parser::type("text"))).rawIntrinsic(&sayIntrinsic));
+    auto type = parser::type("text").build(scope);
+    const auto& say = instance::lookupA<instance::Function>(scope, instance::NameView{"say"});
+
+    auto value = parser::Value{type};
+    value.set<std::string>() = "Hello from compile time!";
+    auto call = CallChain::callWith(say, std::move(value));
+
+    auto compiler = execution::Compiler{};
+    auto context = execution::Context{};
+    context.compiler = &compiler;
+
+    while (state.keepRunning()) {
+        for (auto i = 0; i < state.arg(); i++) Engine::runCall(call, context);
+    }
+    bench::doNotOptimize(g_sum);
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+
+/// loop of calls to an intrinsic that takes a text, like Rebuild.say
+void sayCallsMachine(bench::State& state) { runSay<execution::Machine>(state); }
+BENCHMARK(sayCallsMachine, 1, 64);
+
+/// same calls through the VM
+void sayCallsVM(bench::State& state) { runSay<execution::VM>(state); }
+BENCHMARK(sayCallsVM, 1, 64);
+
+} // namespace
@@ -1,6 +1,9 @@
 #pragma once
 #include "execution/Frame.h"
+#include "execution/Profiler.h"
 #include "execution/Stack.h"
+#include "execution/StackOverflow.h"
+#include "execution/Trace.h"
 
 #include "parser/Tree.h"
 
@@ -16,11 +19,129 @@ namespace execution {
 
 using ParseBlock = std::function<parser::Block(const nesting::BlockLiteral& block, instance::Scope* scope)>;
 using ReportDiagnositc = std::function<void(diagnostic::Diagnostic)>;
+using ParseFunctionBody =
+    std::function<void(const nesting::BlockLiteral& block, instance::Function& function, instance::Scope* scope)>;
+using FunctionDeclared = std::function<void(const instance::Function&)>;
+
+/// state of the execution when the step budget is exhausted
+struct StepProgress {
+    uint64_t steps{}; // steps of all runs so far
+    const CallChain& chain; // the running calls, the hot call site first
+};
+/// grants the number of additional steps, 0 aborts the execution
+using StepBudgetExhausted = std::function<uint64_t(const StepProgress&)>;
+
+/// updates all data the execution derives from the body of the function
+inline void prepareBody(instance::Function& function) {
+    function.body.executable.reset();
+    function.body.updateIntrinsic();
+    resolveSlots(function);
+}
+
+/// bodies with fewer lines are parsed on the heap
+/// note: their few nodes cost less than the chunk and the shared ownership of an arena
+constexpr auto bodyArenaMinLines = size_t{4};
+
+/// arena for the nodes of a single function body, nullptr if the body is parsed on the heap
+/// note: small chunks, most bodies are only a few lines
+inline auto makeBodyArena(const nesting::BlockLiteral& block) -> std::shared_ptr<meta::Arena> {
+    if (block.value.lines.size() < bodyArenaMinLines) return {};
+    return std::make_shared<meta::Arena>(4 * 1024);
+}
+
+/// parses the body of function with its parameters in scope
+/// note: the body owns the arena of its nodes, the previous body is destroyed before its arena
+inline void parseFunctionBodyNow(
+    const ParseBlock& parseBlock, const nesting::BlockLiteral& block, instance::Function& function, instance::Scope* scope) {
+    auto parameterScope = instance::Scope(scope);
+    parameterScope.locals = std::move(function.parameterScope);
+
+    auto arena = makeBodyArena(block);
+    auto bodyScope = instance::Scope(&parameterScope);
+    {
+        auto arenaScope = meta::ArenaScope{arena.get()};
+        function.body.block = parseBlock(block, &bodyScope);
+    }
+    function.body.locals = std::move(bodyScope.locals);
+    function.body.arena = std::move(arena);
+    prepareBody(function);
+
+    function.parameterScope = std::move(parameterScope.locals);
+}
 
 struct Compiler {
     Stack stack{}; // stack allocator
     ParseBlock parseBlock{};
+    ParseFunctionBody parseFunctionBody{}; // optional, parses immediately otherwise
     ReportDiagnositc reportDiagnostic = [](diagnostic::Diagnostic) {};
+    FunctionDeclared functionDeclared = [](const instance::Function&) {};
+    size_t callDepthLimit{defaultCallDepthLimit}; // deeper calls report a diagnostic and abort
+    uint64_t steps{}; // each call and intrinsic is one step
+    uint64_t stepLimit{}; // the host is asked when steps reach it, 0 is unlimited
+    StepBudgetExhausted stepBudgetExhausted = [](const StepProgress&) -> uint64_t { return 0; };
+    Profiler* profiler{}; // optional, records all calls
+    Trace* trace{}; // optional, spans of all calls and intrinsics
+    bool aborted{}; // a fatal error stopped the execution, no further calls are run
+
+    static constexpr size_t defaultCallDepthLimit = 100'000;
+
+    /// reports the overflow and aborts
+    void stackOverflow(const CallChain& chain) {
+        reportDiagnostic(stackOverflowDiagnostic(stack, chain));
+        aborted = true;
+    }
+
+    /// counts a step, returns false if the budget is exhausted and the host aborted
+    /// note: the call chain is only built when the host is asked
+    template<class CallChainFunc>
+    bool step(CallChainFunc&& callChain) {
+        if (++steps != stepLimit) return true;
+        return extendStepBudget(callChain());
+    }
+
+    /// asks the host for more steps, reports the hot call site and aborts otherwise
+    bool extendStepBudget(const CallChain& chain) {
+        if (auto more = stepBudgetExhausted(StepProgress{steps, chain}); more != 0) {
+            stepLimit = steps + more;
+            return true;
+        }
+        reportDiagnostic(stepBudgetDiagnostic(steps, chain));
+        aborted = true;
+        return false;
+    }
+
+    /// begins the span of a call and updates the stack counter, requires a trace
+    void beginTrace(const instance::Function& function) {
+        trace->counter("stack", stack.used());
+        const auto& name = function.name;
+        trace->begin(function.body.intrinsic ? "intrinsic" : "call", std::string(name.begin(), name.end()));
+    }
+
+    /// traces the call until the span leaves the scope
+    auto traceCall(const instance::Function& function) -> TraceSpan {
+        if (!trace) return {};
+        beginTrace(function);
+        return TraceSpan{trace};
+    }
+
+    /// traces an intrinsic of a function body until the span leaves the scope
+    auto traceIntrinsic() -> TraceSpan {
+        if (!trace) return {};
+        trace->begin("intrinsic", "intrinsic");
+        return TraceSpan{trace};
+    }
+
+    /// reports the exceeded depth and aborts
+    void callDepthExceeded(const CallChain& chain) {
+        reportDiagnostic(callDepthDiagnostic(callDepthLimit, chain));
+        aborted = true;
+    }
+
+    /// reports the node the VM cannot run and aborts
+    void unsupported(const char* reason, const CallChain& chain) {
+        reportDiagnostic(unsupportedDiagnostic(reason, chain));
+        aborted = true;
+    }
 };
 
 struct Context {
@@ -28,16 +149,25 @@ struct Context {
     Compiler* compiler{};
 
     const Context* caller{};
+    instance::FunctionView function{}; // called function of a call context
     instance::Scope* parserScope{};
 
     Byte* localBase{};
-    LocalFrame localFrame{};
 
-    auto operator[](instance::TypedView typed) const& -> Byte* {
-        auto addr = localFrame[typed];
-        if (addr) return addr;
-        if (parent) return (*parent)[typed];
-        return nullptr;
+    auto operator[](parser::FrameSlot slot) const& -> Byte* {
+        assert(slot.resolved());
+        const auto* frame = this;
+        for (auto depth = slot.depth; depth > 0; depth--) frame = frame->parent;
+        return frame->localBase + slot.offset;
+    }
+
+    /// functions of all running calls
+    auto callChain() const -> CallChain {
+        auto chain = CallChain{};
+        for (const auto* context = this; context; context = context->parent ? context->parent : context->caller) {
+            if (context->function) chain.push_back(context->function);
+        }
+        return chain;
     }
 
     auto createCall() const -> Context {
@@ -68,25 +198,88 @@ struct IntrinsicContext : intrinsic::Context {
     }
 
     void report(diagnostic::Diagnostic diagnostic) override { compiler->reportDiagnostic(std::move(diagnostic)); }
+
+    void parseBody(const parser::BlockLiteral& block, instance::Function& function) override {
+        if (compiler->parseFunctionBody)
+            compiler->parseFunctionBody(block, function, parserScope);
+        else
+            parseFunctionBodyNow(compiler->parseBlock, block, function, parserScope);
+    }
+
+    void declared(const instance::Function& function) override { compiler->functionDeclared(function); }
 };
 
+/// tree walking interpreter
+/// note: the VM is used by the compiler, the Machine stays as the reference
+/// note: recurses on the native stack, it does not check the callDepthLimit
 struct Machine {
     static void runCall(const parser::Call& call, const Context& context) {
-        auto stackSize = argumentsSize(*call.function);
+        if (context.compiler->aborted) return;
+        auto stackSize = callFrameSize(call);
         auto stackData = context.compiler->stack.allocate(stackSize);
 
         auto callContext = context.createCall();
+        callContext.function = call.function;
+        if (!stackData) return stackOverflow(callContext);
         callContext.localBase = stackData.get();
         storeArguments(call, callContext);
 
         runFunction(*call.function, callContext);
+        if (!context.compiler->aborted) destructArguments(*call.function, callContext.localBase);
     }
 
     static void runBlock(const parser::Block& block, const Context& context) {
+        if (context.compiler->aborted) return;
         auto blockContext = context.createCall();
         runFunctionBlock(block, blockContext);
     }
 
+    static auto argumentsSize(const instance::Function& fun) -> size_t {
+        auto sum = 0u;
+        for (auto* param : fun.parameters) {
+            sum += argumentSize(*param);
+        }
+        return sum;
+    }
+    static auto argumentSize(const instance::Parameter& arg) -> size_t {
+        using namespace instance;
+        if (arg.flags.any(ParameterFlag::splatted)) {
+            return 8; // TODO(arBmind): sizeof(Array)
+        }
+        if (arg.flags.any(ParameterFlag::assignable)) {
+            return sizeof(void*); // passed as pointer
+        }
+        return typeExpressionSize(arg.typed.type);
+    }
+
+    static auto typeExpressionSize(const parser::TypeView& type) -> size_t { return type->size; }
+
+    /// result without an argument, the call is a statement and the result is dropped
+    static bool isDiscardedResult(const parser::Call& call, const instance::Parameter& param) {
+        return param.side == instance::ParameterSide::result && param.init.empty() &&
+            findAssign(call.arguments, param) == nullptr;
+    }
+
+    /// the arguments followed by the storage of the dropped results
+    static auto callFrameSize(const parser::Call& call) -> size_t {
+        auto size = argumentsSize(*call.function);
+        for (auto* param : call.function->parameters) {
+            if (!isDiscardedResult(call, *param)) continue;
+            size = alignOffset(size, param->typed.type->alignment) + typeExpressionSize(param->typed.type);
+        }
+        return size;
+    }
+
+    /// the frame holds a value of the argument, that has to be destructed after the call
+    static bool ownsArgument(const instance::Parameter& arg) {
+        using namespace instance;
+        return arg.side != ParameterSide::result && !arg.flags.any(ParameterFlag::splatted, ParameterFlag::assignable);
+    }
+
+    static void destructValue(const parser::TypeView& type, Byte* memory) {
+        if (type->destructFunc) parser::destructValue(*type, memory);
+    }
+
 private:
     static void runNode(const parser::Node& node, Context& context) {
         node.visit(
@@ -103,7 +296,7 @@ private:
     }
 
     static void initVariable(const parser::VariableInit& var, Context& context) {
-        auto memory = context[&var.variable->typed];
+        auto memory = context[var.slot];
         if (var.nodes.size() == 1) {
             for (const auto& node : var.nodes) {
                 storeNode(node, context, memory);
@@ -112,71 +305,83 @@ private:
     }
 
     static void runFunctionBlock(const parser::Block& block, Context& context) {
-        auto frameSize = variablesInBlockSize(block.nodes);
-        auto frameData = context.compiler->stack.allocate(frameSize);
+        auto frameData = context.compiler->stack.allocate(block.frameSize);
+        if (!frameData) return stackOverflow(context);
 
         auto nested = context.createNested();
         nested.localBase = frameData.get();
-        layoutVariables(block.nodes, nested);
 
         for (const auto& node : block.nodes) {
+            if (context.compiler->aborted) return;
             runNode(node, nested);
         }
+        if (!context.compiler->aborted) destructVariables(block, nested.localBase);
     }
 
+    // note: frames of an aborted execution are not destructed, it is unknown which values were constructed
+    static void destructVariables(const parser::Block& block, Byte* frame) {
+        for (auto it = block.nodes.rbegin(); it != block.nodes.rend(); ++it) {
+            it->visitSome([&](const parser::VariableInit& var) {
+                if (var.nodes.size() == 1) destructValue(var.variable->typed.type, frame + var.slot.offset);
+            });
+        }
+    }
+
+    static void destructArguments(const instance::Function& fun, Byte* memory) {
+        auto offset = argumentsSize(fun);
+        for (auto it = fun.parameters.rbegin(); it != fun.parameters.rend(); ++it) {
+            offset -= argumentSize(**it);
+            if (ownsArgument(**it)) destructValue((*it)->typed.type, memory + offset);
+        }
+    }
+
+    static void stackOverflow(const Context& context) { context.compiler->stackOverflow(context.callChain()); }
+
     static void runIntrinsic(const parser::IntrinsicCall& intrinsic, Context& context) {
+        if (!context.compiler->step([&] { return context.callChain(); })) return;
+        if (auto* profiler = context.compiler->profiler; profiler) profiler->intrinsic();
+        auto span = context.compiler->traceIntrinsic();
         Byte* memory = context.parent->localBase; // arguments
         auto intrinsicContext = IntrinsicContext{context, nullptr};
         intrinsic.exec(memory, &intrinsicContext);
     }
 
     static void runFunction(const instance::Function& function, Context& context) {
+        if (!context.compiler->step([&] { return context.callChain(); })) return;
+        auto profile = ProfileCall{context.compiler->profiler, &function, context.compiler->stack.used()};
+        auto span = context.compiler->traceCall(function);
+        if (function.body.intrinsic) return runDirectIntrinsic(function.body.intrinsic, context);
         runFunctionBlock(function.body.block, context);
     }
 
+    // note: skips the block, the arguments are already laid out as the intrinsic expects them
+    static void runDirectIntrinsic(parser::IntrinsicCall::Exec exec, Context& context) {
+        if (auto* profiler = context.compiler->profiler; profiler) profiler->intrinsic();
+        auto intrinsicContext = IntrinsicContext{context, nullptr};
+        exec(context.localBase, &intrinsicContext);
+    }
+
     static void runTyped(const parser::NameTypeValueTuple& typed, Context& context) {
         for (const auto& entry : typed.tuple) {
             runNode(entry.value.value(), context);
         }
     }
 
-    static auto variablesInBlockSize(const parser::Nodes& nodes) -> size_t {
-        auto sum = 0u;
-        for (auto& n : nodes) {
-            n.visitSome([&](const parser::VariableInit& var) { //
-                sum += typeExpressionSize(var.variable->typed.type);
-            });
-        }
-        return sum;
-    }
-
-    static auto argumentsSize(const instance::Function& fun) -> size_t {
-        auto sum = 0u;
-        for (auto* param : fun.parameters) {
-            sum += argumentSize(*param);
-        }
-        return sum;
-    }
-    static auto argumentSize(const instance::Parameter& arg) -> size_t {
-        using namespace instance;
-        if (arg.flags.any(ParameterFlag::splatted)) {
-            return 8; // TODO(arBmind): sizeof(Array)
-        }
-        if (arg.flags.any(ParameterFlag::assignable)) {
-            return sizeof(void*); // passed as pointer
-        }
-        return typeExpressionSize(arg.typed.type);
-    }
-
-    static auto typeExpressionSize(const parser::TypeView& type) -> size_t { return type->size; }
-
+    // note: the dropped results are written by the callee and never destructed
     static void storeArguments(const parser::Call& call, Context& context) {
         Byte* memory = context.localBase;
         const auto& fun = *call.function;
+        auto discarded = argumentsSize(fun);
         // assert(call.arguments sufficient & valid)
         for (auto* funParam : fun.parameters) {
-            context.localFrame.insert(&funParam->typed, memory);
-            assignArgument(call, *funParam, context, memory);
+            if (isDiscardedResult(call, *funParam)) {
+                discarded = alignOffset(discarded, funParam->typed.type->alignment);
+                storeResultAt(memory, *funParam, context.localBase + discarded);
+                discarded += typeExpressionSize(funParam->typed.type);
+            }
+            else {
+                assignArgument(call, *funParam, context, memory);
+            }
             memory += argumentSize(*funParam);
         }
     }
@@ -200,7 +405,6 @@ private:
         const auto& fun = *call.function;
         // assert(call.arguments sufficient & valid)
         for (auto* funParam : fun.parameters) {
-            context.localFrame.insert(&funParam->typed, memory);
             if (funParam->side == instance::ParameterSide::result) {
                 storeResultAt(memory, *funParam, result);
             }
@@ -211,16 +415,6 @@ private:
         }
     }
 
-    static void layoutVariables(const parser::Nodes& nodes, Context& context) {
-        Byte* memory = context.localBase;
-        for (const auto& node : nodes) {
-            node.visitSome([&](const parser::VariableInit& var) { //
-                context.localFrame.insert(&var.variable->typed, memory);
-                memory += typeExpressionSize(var.variable->typed.type);
-            });
-        }
-    }
-
     static auto findAssign(const parser::ArgumentAssignments& assignments, const instance::Parameter& param)
         -> const parser::ArgumentAssignment* {
         for (const auto& assign : assignments) {
@@ -243,10 +437,8 @@ private:
         if (param.flags.any(ParameterFlag::assignable)) {
             assert(nodes.size() == 1);
             nodes[0].visit(
-                [&](const parser::VariableReference& var) { storeTypedAddress(var.variable->typed, context, memory); },
-                [&](const parser::ParameterReference& param) {
-                    storeTypedAddress(param.parameter->typed, context, memory);
-                },
+                [&](const parser::VariableReference& var) { storeSlotAddress(var.slot, context, memory); },
+                [&](const parser::ParameterReference& param) { storeSlotAddress(param.slot, context, memory); },
                 [&](const parser::Value& value) { storeValueAddress(value, memory); },
                 [&](const auto&) { assert(false); });
             return;
@@ -266,8 +458,10 @@ private:
             [&](const parser::Block&) { assert(false); },
             [&](const parser::Call& call) { storeCallResult(call, context, memory); },
             [&](const parser::IntrinsicCall&) { assert(false); },
-            [&](const parser::ParameterReference& param) { storeTypedValue(param.parameter->typed, context, memory); },
-            [&](const parser::VariableReference& var) { storeTypedValue(var.variable->typed, context, memory); },
+            [&](const parser::ParameterReference& param) {
+                storeSlotValue(param.parameter->typed, param.slot, context, memory);
+            },
+            [&](const parser::VariableReference& var) { storeSlotValue(var.variable->typed, var.slot, context, memory); },
             [&](const parser::NameTypeValueReference& ref) {
                 if (ref.nameTypeValue && ref.nameTypeValue->value)
                     storeNode(ref.nameTypeValue->value.value(), context, memory);
@@ -281,27 +475,31 @@ private:
     }
 
     static void storeCallResult(const parser::Call& call, const Context& context, Byte* memory) {
+        if (context.compiler->aborted) return;
         auto stackSize = argumentsSize(*call.function);
         auto stackData = context.compiler->stack.allocate(stackSize);
 
         auto callContext = context.createCall();
+        callContext.function = call.function;
+        if (!stackData) return stackOverflow(callContext);
         callContext.localBase = stackData.get();
         storeArgumentsAt(call, callContext, memory);
 
         runFunction(*call.function, callContext);
+        if (!context.compiler->aborted) destructArguments(*call.function, callContext.localBase);
     }
 
-    static void storeTypedAddress(const instance::Typed& typed, const Context& context, Byte* memory) {
-        reinterpret_cast<void*&>(*memory) = context[&typed];
+    static void storeSlotAddress(parser::FrameSlot slot, const Context& context, Byte* memory) {
+        reinterpret_cast<void*&>(*memory) = context[slot];
     }
 
     static void storeValueAddress(const parser::Value& value, Byte* memory) {
         reinterpret_cast<const void*&>(*memory) = value.data(); // store pointer to real instance
     }
 
-    static void storeTypedValue(const instance::Typed& typed, const Context& context, Byte* memory) {
-        auto* source = context[&typed];
-        assert(source);
+    static void storeSlotValue(
+        const instance::Typed& typed, parser::FrameSlot slot, const Context& context, Byte* memory) {
+        auto* source = context[slot];
         cloneTypeInto(typed.type, memory, source);
     }
 
@@ -314,7 +512,7 @@ private:
     }
 
     static void cloneTypeInto(const parser::TypeView& type, Byte* dest, const Byte* source) {
-        type->cloneFunc(dest, source);
+        parser::cloneValue(*type, dest, source);
     }
 };
 
@@ -0,0 +1,91 @@
+#include "Profiler.h"
+
+#include "instance/Function.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+namespace execution {
+
+namespace {
+
+auto microseconds(ProfileClock::duration duration) -> uint64_t {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+auto nameOf(instance::FunctionView function) -> std::string {
+    const auto& name = function->name;
+    return std::string(name.begin(), name.end());
+}
+
+} // namespace
+
+void Profiler::enter(instance::FunctionView function, size_t stackUsed) {
+    auto& entry = m_entries[function];
+    entry.profile.function = function;
+    entry.profile.calls++;
+    entry.profile.stackUsed = std::max(entry.profile.stackUsed, stackUsed);
+    entry.running++;
+
+    auto parent = m_active.empty() ? root : m_active.back().node;
+    auto node = childNode(parent, function);
+    m_active.push_back(Active{&entry.profile, &entry.running, node, ProfileClock::now(), {}});
+}
+
+void Profiler::leave() {
+    auto active = m_active.back();
+    m_active.pop_back();
+
+    auto elapsed = ProfileClock::now() - active.start;
+    auto exclusive = elapsed - active.callees;
+    active.profile->exclusive += exclusive;
+    m_nodes[active.node].exclusive += exclusive;
+    if (--*active.running == 0) active.profile->inclusive += elapsed;
+    if (!m_active.empty()) m_active.back().callees += elapsed;
+}
+
+auto Profiler::childNode(NodeIndex parent, instance::FunctionView function) -> NodeIndex {
+    auto [it, inserted] = m_children.try_emplace({parent, function}, static_cast<NodeIndex>(m_nodes.size()));
+    if (inserted) m_nodes.push_back(Node{function, parent, {}});
+    return it->second;
+}
+
+auto Profiler::profiles() const -> std::vector<FunctionProfile> {
+    auto result = std::vector<FunctionProfile>{};
+    result.reserve(m_entries.size());
+    for (const auto& [function, entry] : m_entries) result.push_back(entry.profile);
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+        if (a.exclusive != b.exclusive) return a.exclusive > b.exclusive;
+        return a.calls > b.calls;
+    });
+    return result;
+}
+
+void Profiler::writeReport(std::ostream& out) const {
+    out << "\nCompile time profile:\n";
+    out << std::setw(10) << "calls" << std::setw(12) << "intrinsics" << std::setw(14) << "inclusive us"
+        << std::setw(14) << "exclusive us" << std::setw(12) << "stack" << "  function\n";
+    for (const auto& profile : profiles()) {
+        out << std::setw(10) << profile.calls << std::setw(12) << profile.intrinsics << std::setw(14)
+            << microseconds(profile.inclusive) << std::setw(14) << microseconds(profile.exclusive) << std::setw(12)
+            << profile.stackUsed << "  " << nameOf(profile.function) << '\n';
+    }
+}
+
+void Profiler::writeFoldedStacks(std::ostream& out) const {
+    auto stack = std::vector<NodeIndex>{};
+    for (auto index = NodeIndex{1}; index < m_nodes.size(); index++) {
+        stack.clear();
+        for (auto node = index; node != root; node = m_nodes[node].parent) stack.push_back(node);
+
+        auto separator = "";
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+            out << separator << nameOf(m_nodes[*it].function);
+            separator = ";";
+        }
+        out << ' ' << std::chrono::duration_cast<std::chrono::nanoseconds>(m_nodes[index].exclusive).count() << '\n';
+    }
+}
+
+} // namespace execution
@@ -0,0 +1,94 @@
+#pragma once
+#include "instance/Views.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace execution {
+
+using ProfileClock = std::chrono::steady_clock;
+
+/// measurements of all calls of one function
+struct FunctionProfile {
+    instance::FunctionView function{};
+    uint64_t calls{};
+    uint64_t intrinsics{}; // intrinsic invocations while the function was the innermost call
+    ProfileClock::duration inclusive{}; // note: nested recursive calls are part of the outermost call
+    ProfileClock::duration exclusive{}; // without the time of the called functions
+    size_t stackUsed{}; // most bytes of the stack in use at the start of a call
+};
+
+/// records the compile time calls of the execution
+///
+/// * enter and leave have to be nested like the calls
+/// * calls with the same chain of callers share one node of a call tree, it carries the folded stacks
+struct Profiler {
+    using This = Profiler;
+    using Duration = ProfileClock::duration;
+
+    void enter(instance::FunctionView function, size_t stackUsed);
+    void leave();
+    void intrinsic() {
+        if (!m_active.empty()) m_active.back().profile->intrinsics++;
+    }
+
+    /// profiles of all called functions, the highest exclusive time first
+    auto profiles() const -> std::vector<FunctionProfile>;
+
+    /// table of the profiles
+    void writeReport(std::ostream& out) const;
+
+    /// one line per call chain "outer;inner nanoseconds" as flamegraph tools expect them
+    void writeFoldedStacks(std::ostream& out) const;
+
+private:
+    using NodeIndex = uint32_t;
+    static constexpr auto root = NodeIndex{};
+
+    struct Node {
+        instance::FunctionView function{};
+        NodeIndex parent{};
+        Duration exclusive{};
+    };
+    struct Entry {
+        FunctionProfile profile{};
+        uint32_t running{}; // active calls, recursions are only measured once inclusive
+    };
+    struct Active {
+        FunctionProfile* profile{};
+        uint32_t* running{};
+        NodeIndex node{};
+        ProfileClock::time_point start{};
+        Duration callees{};
+    };
+
+    auto childNode(NodeIndex parent, instance::FunctionView function) -> NodeIndex;
+
+    std::vector<Node> m_nodes{Node{}}; // starts with the root
+    std::map<std::pair<NodeIndex, instance::FunctionView>, NodeIndex> m_children{};
+    std::unordered_map<instance::FunctionView, Entry> m_entries{};
+    std::vector<Active> m_active{};
+};
+
+/// profiles a call while it is in scope, does nothing without a profiler
+struct ProfileCall {
+    Profiler* profiler{};
+
+    ProfileCall(Profiler* profiler, instance::FunctionView function, size_t stackUsed)
+        : profiler(profiler) {
+        if (profiler) profiler->enter(function, stackUsed);
+    }
+    ~ProfileCall() {
+        if (profiler) profiler->leave();
+    }
+
+    ProfileCall(const ProfileCall&) = delete;
+    auto operator=(const ProfileCall&) -> ProfileCall& = delete;
+};
+
+} // namespace execution
@@ -0,0 +1,70 @@
+#include "execution/Profiler.h"
+
+#include "instance/Function.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<size_t N>
+auto function(const char (&name)[N]) -> instance::Function {
+    auto function = instance::Function{};
+    function.name = instance::Name{name};
+    return function;
+}
+
+} // namespace
+
+TEST(profiler, nestedCalls) {
+    auto outer = function("outer");
+    auto inner = function("inner");
+
+    auto profiler = execution::Profiler{};
+    profiler.enter(&outer, 16);
+    profiler.enter(&inner, 48);
+    profiler.intrinsic();
+    profiler.intrinsic();
+    profiler.leave();
+    profiler.enter(&outer, 32); // recursion
+    profiler.leave();
+    profiler.leave();
+
+    auto profiles = profiler.profiles();
+    ASSERT_EQ(profiles.size(), 2u);
+    const auto& outerProfile = profiles[0].function == &outer ? profiles[0] : profiles[1];
+    const auto& innerProfile = profiles[0].function == &inner ? profiles[0] : profiles[1];
+    EXPECT_EQ(outerProfile.calls, 2u);
+    EXPECT_EQ(outerProfile.intrinsics, 0u);
+    EXPECT_EQ(outerProfile.stackUsed, 32u);
+    EXPECT_EQ(innerProfile.calls, 1u);
+    EXPECT_EQ(innerProfile.intrinsics, 2u);
+    EXPECT_EQ(innerProfile.stackUsed, 48u);
+    EXPECT_GE(outerProfile.inclusive, outerProfile.exclusive);
+    EXPECT_GE(outerProfile.inclusive, innerProfile.inclusive);
+    EXPECT_GE(profiles[0].exclusive, profiles[1].exclusive);
+}
+
+TEST(profiler, foldedStacks) {
+    auto outer = function("outer");
+    auto inner = function("inner");
+
+    auto profiler = execution::Profiler{};
+    for (auto i = 0; i < 2; i++) {
+        profiler.enter(&outer, 0);
+        profiler.enter(&inner, 0);
+        profiler.leave();
+        profiler.leave();
+    }
+    profiler.enter(&inner, 0);
+    profiler.leave();
+
+    auto out = std::stringstream{};
+    profiler.writeFoldedStacks(out);
+    auto stacks = std::vector<std::string>{};
+    for (auto line = std::string{}; std::getline(out, line);) stacks.push_back(line.substr(0, line.find(' ')));
+    EXPECT_EQ(stacks, (std::vector<std::string>{"outer", "outer;inner", "inner"}));
+}
@@ -1,26 +1,59 @@
 #include "Stack.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace execution {
 
-Stack::Stack(size_t total)
-    : data(new Byte[total])
-    , total{total}
-    , used{0} {}
+Stack::Stack(size_t segmentSize, size_t limit)
+    : m_segmentSize(std::max<size_t>(segmentSize, 1))
+    , m_limit(limit) {
+    m_segments.push_back(Segment{std::make_unique<Byte[]>(m_segmentSize), m_segmentSize});
+    m_stats.segments = 1;
+}
 
-auto Stack::allocate(size_t size) -> Ptr {
-    if (size > 0 && used + size < total) {
-        auto p = data.get() + used;
-        used += size;
-        return Ptr{p, StackDeleter{this, size}};
+auto Stack::allocate(size_t size, size_t alignment) -> Ptr {
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0); // power of two
+    auto before = m_top;
+    while (true) {
+        auto& segment = m_segments[m_top.segment];
+        auto base = reinterpret_cast<uintptr_t>(segment.data.get());
+        auto aligned = (base + m_top.offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        auto end = aligned - base + size;
+        if (end <= segment.size) {
+            auto used = m_top.used + (end - m_top.offset);
+            if (used > m_limit) break;
+            m_top.offset = end;
+            m_top.used = used;
+            m_stats.highWaterMark = std::max(m_stats.highWaterMark, used);
+            return Ptr{reinterpret_cast<Byte*>(aligned), StackDeleter{this, before}};
+        }
+        // note: the tail of the segment counts as used until the allocation is released
+        m_top.used += segment.size - m_top.offset;
+        if (m_top.used + size > m_limit) break;
+        nextSegment(size + alignment);
     }
+    m_top = before;
     return {};
 }
 
-void Stack::free(size_t size) {
-    assert(used >= size);
-    used -= size;
+void Stack::release(Mark mark) {
+    assert(mark.used <= m_top.used);
+    m_top = mark;
+}
+
+void Stack::nextSegment(size_t minSize) {
+    auto index = m_top.segment + 1;
+    if (index < m_segments.size() && m_segments[index].size < minSize) {
+        m_segments.resize(index); // note: all later segments are unused
+    }
+    if (index == m_segments.size()) {
+        auto size = std::max(m_segmentSize, minSize);
+        m_segments.push_back(Segment{std::make_unique<Byte[]>(size), size});
+        m_stats.segments++;
+    }
+    m_top.segment = index;
+    m_top.offset = 0;
 }
 
 } // namespace execution
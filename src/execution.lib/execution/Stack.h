@@ -1,34 +1,85 @@
 #pragma once
 #include <cinttypes>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace execution {
 
 using Byte = uint8_t;
 
+/// rounds the offset up to the alignment, 0 counts as 1
+constexpr auto alignOffset(size_t offset, size_t alignment) -> size_t {
+    return alignment > 1 ? (offset + alignment - 1) / alignment * alignment : offset;
+}
+
+/// counters of the stack usage
+struct StackStats {
+    size_t highWaterMark{}; // most bytes in use at once, including alignment and skipped segment tails
+    size_t segments{}; // number of allocated segments
+};
+
 /**
- * initially allocated once never invalidates pointers!
+ * segmented stack allocator
+ *
+ * - grows by chaining segments, never invalidates pointers!
+ * - allocations have to be released in reverse order
+ * - returns an empty Ptr once more than the limit would be in use
  */
 struct Stack {
-    Stack(size_t total = 1024 * 1024);
+    using This = Stack;
+    static constexpr size_t defaultSegmentSize = 1024 * 1024;
+    static constexpr size_t defaultLimit = 64 * 1024 * 1024;
+    static constexpr size_t defaultAlignment = alignof(std::max_align_t);
+
+    explicit Stack(size_t segmentSize = defaultSegmentSize, size_t limit = defaultLimit);
+    ~Stack() = default;
+
+    // no copy
+    Stack(const This&) = delete;
+    auto operator=(const This&) -> This& = delete;
+    // move
+    // note: only move an empty stack, released pointers refer to it
+    Stack(This&&) = default;
+    auto operator=(This&&) -> This& = default;
+
+    /// position of the top of the stack
+    struct Mark {
+        size_t segment{};
+        size_t offset{}; // bytes used in the segment
+        size_t used{}; // bytes used in all segments
+    };
 
     struct StackDeleter {
         Stack* stack;
-        size_t size;
+        Mark mark; // top before the allocation
 
         auto operator()(void* p) -> void {
-            if (p != nullptr) stack->free(size);
+            if (p != nullptr) stack->release(mark);
         }
     };
     using Ptr = std::unique_ptr<Byte, StackDeleter>;
 
-    auto allocate(size_t) -> Ptr;
-    void free(size_t);
+    /// note: zero sized allocations return the top of the stack
+    auto allocate(size_t size, size_t alignment = defaultAlignment) -> Ptr;
+
+    auto used() const -> size_t { return m_top.used; }
+    auto limit() const -> size_t { return m_limit; }
+    auto stats() const -> const StackStats& { return m_stats; }
 
 private:
-    std::unique_ptr<Byte[]> data;
-    size_t total{};
-    size_t used{};
+    void release(Mark mark);
+    void nextSegment(size_t minSize);
+
+    struct Segment {
+        std::unique_ptr<Byte[]> data;
+        size_t size{};
+    };
+    std::vector<Segment> m_segments{};
+    size_t m_segmentSize{};
+    size_t m_limit{};
+    Mark m_top{};
+    StackStats m_stats{};
 };
 
 } // namespace execution
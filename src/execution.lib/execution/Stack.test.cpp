@@ -0,0 +1,53 @@
+#include "execution/Stack.h"
+
+#include "gtest/gtest.h"
+
+using execution::Stack;
+
+TEST(stack, alignsAllocations) {
+    auto stack = Stack{256};
+    auto a = stack.allocate(1, 1);
+    auto b = stack.allocate(3, 8);
+    auto c = stack.allocate(16, 32);
+    ASSERT_TRUE(a && b && c);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b.get()) % 8, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c.get()) % 32, 0u);
+    EXPECT_EQ(execution::alignOffset(5, 4), 8u);
+    EXPECT_EQ(execution::alignOffset(5, 0), 5u);
+}
+
+TEST(stack, growsBySegments) {
+    auto stack = Stack{64, 1024};
+    auto first = stack.allocate(48);
+    ASSERT_TRUE(first);
+    auto* firstAddress = first.get();
+    firstAddress[0] = 42;
+
+    auto second = stack.allocate(48); // does not fit the first segment
+    auto large = stack.allocate(200); // larger than a segment
+    ASSERT_TRUE(second && large);
+    EXPECT_EQ(stack.stats().segments, 3u);
+    EXPECT_EQ(first.get(), firstAddress);
+    EXPECT_EQ(firstAddress[0], 42);
+
+    large.reset();
+    second.reset();
+    auto reused = stack.allocate(48);
+    ASSERT_TRUE(reused);
+    EXPECT_EQ(stack.stats().segments, 3u);
+}
+
+TEST(stack, limitAndHighWaterMark) {
+    auto stack = Stack{64, 128};
+    {
+        auto a = stack.allocate(64);
+        auto b = stack.allocate(64);
+        ASSERT_TRUE(a && b);
+        EXPECT_EQ(stack.used(), 128u);
+        EXPECT_FALSE(stack.allocate(1));
+        EXPECT_EQ(stack.used(), 128u);
+    }
+    EXPECT_EQ(stack.used(), 0u);
+    EXPECT_EQ(stack.stats().highWaterMark, 128u);
+    EXPECT_TRUE(stack.allocate(0));
+}
@@ -0,0 +1,63 @@
+#include "StackOverflow.h"
+
+#include "instance/Function.h"
+
+#include <string>
+
+namespace execution {
+
+namespace {
+
+constexpr auto shownCalls = size_t{16}; // note: deep recursions would create huge diagnostics
+
+auto toString(const std::string& text) -> strings::String { return strings::String{text.data(), text.data() + text.size()}; }
+
+auto withCallChain(uint32_t number, const char* title, const std::string& text, const CallChain& chain)
+    -> diagnostic::Diagnostic {
+    using namespace diagnostic;
+    auto calls = std::string{};
+    for (auto i = 0u; i < chain.size() && i < shownCalls; i++) {
+        const auto& name = chain[i]->name;
+        calls.append(name.begin(), name.end());
+        calls += '\n';
+    }
+    if (chain.size() > shownCalls) calls += "... " + std::to_string(chain.size() - shownCalls) + " more calls\n";
+
+    auto doc = Document{{Paragraph{toString(text), {}}, Headline{String{"Call chain"}}, CodeBlock{toString(calls), {}}}};
+    return Diagnostic{Code{String{"rebuild-execution"}, number}, Parts{Explanation{toString(title), doc}}};
+}
+
+} // namespace
+
+auto stackOverflowDiagnostic(const Stack& stack, const CallChain& chain) -> diagnostic::Diagnostic {
+    auto text = "The compile time execution needs more than " + std::to_string(stack.limit()) +
+        " bytes of stack. Check for unbounded recursions or raise the stack limit.";
+    return withCallChain(1, "Stack Overflow", text, chain);
+}
+
+auto callDepthDiagnostic(size_t limit, const CallChain& chain) -> diagnostic::Diagnostic {
+    auto text = "The compile time execution nests more than " + std::to_string(limit) +
+        " calls. Check for unbounded recursions or raise the call depth limit.";
+    return withCallChain(2, "Call Depth Exceeded", text, chain);
+}
+
+auto stepBudgetDiagnostic(uint64_t steps, const CallChain& chain) -> diagnostic::Diagnostic {
+    auto text = "The compile time execution was aborted after " + std::to_string(steps) +
+        " steps. Check for unbounded recursions or raise the step budget.";
+    if (!chain.empty()) {
+        const auto& name = chain.front()->name;
+        text += " The budget ran out in " + std::string(name.begin(), name.end()) + '.';
+    }
+    return withCallChain(3, "Step Budget Exhausted", text, chain);
+}
+
+auto unsupportedDiagnostic(const char* reason, const CallChain& chain) -> diagnostic::Diagnostic {
+    auto text = std::string{"The compile time execution cannot run "} + reason + '.';
+    if (!chain.empty()) {
+        const auto& name = chain.front()->name;
+        text += " It was found in " + std::string(name.begin(), name.end()) + '.';
+    }
+    return withCallChain(4, "Unsupported Execution", text, chain);
+}
+
+} // namespace execution
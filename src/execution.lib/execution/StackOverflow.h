@@ -0,0 +1,26 @@
+#pragma once
+#include "execution/Stack.h"
+
+#include "diagnostic/Diagnostic.h"
+
+#include "instance/Views.h"
+
+#include <vector>
+
+namespace execution {
+
+using CallChain = std::vector<instance::FunctionView>; // innermost call first
+
+/// explains that the compile time execution ran out of stack
+auto stackOverflowDiagnostic(const Stack& stack, const CallChain& chain) -> diagnostic::Diagnostic;
+
+/// explains that the calls of the compile time execution are nested too deep
+auto callDepthDiagnostic(size_t limit, const CallChain& chain) -> diagnostic::Diagnostic;
+
+/// explains that the compile time execution ran out of steps
+auto stepBudgetDiagnostic(uint64_t steps, const CallChain& chain) -> diagnostic::Diagnostic;
+
+/// explains that the VM cannot lower a function body
+auto unsupportedDiagnostic(const char* reason, const CallChain& chain) -> diagnostic::Diagnostic;
+
+} // namespace execution
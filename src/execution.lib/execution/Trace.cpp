@@ -0,0 +1,86 @@
+#include "Trace.h"
+
+#include <cstdio>
+
+namespace execution {
+
+namespace {
+
+void writeString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (auto c : text) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                out << escaped;
+            }
+            else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+Trace::Trace(std::ostream& out)
+    : out(&out)
+    , start(Clock::now()) {
+    out << "{\"traceEvents\":[\n";
+}
+
+void Trace::begin(const char* category, const std::string& name, const Args& args) {
+    event('B', category, name);
+    if (!args.empty()) {
+        *out << ",\"args\":{";
+        auto separator = "";
+        for (const auto& arg : args) {
+            *out << separator << '"' << arg.name << "\":";
+            writeString(*out, arg.value);
+            separator = ",";
+        }
+        *out << '}';
+    }
+    *out << '}';
+    open++;
+}
+
+void Trace::end() {
+    event('E', nullptr, {});
+    *out << '}';
+    open--;
+}
+
+void Trace::counter(const char* name, uint64_t value) {
+    event('C', nullptr, name);
+    *out << ",\"args\":{\"value\":" << value << "}}";
+}
+
+void Trace::finish() {
+    if (finished) return;
+    while (open > 0) end();
+    *out << "\n]}\n";
+    finished = true;
+}
+
+void Trace::event(char phase, const char* category, const std::string& name) {
+    auto timestamp = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    char ts[32];
+    std::snprintf(ts, sizeof(ts), "%.3f", timestamp);
+    *out << (first ? "" : ",\n") << "{\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":1,\"ts\":" << ts;
+    if (category) *out << ",\"cat\":\"" << category << '"';
+    if (!name.empty()) {
+        *out << ",\"name\":";
+        writeString(*out, name);
+    }
+    first = false;
+}
+
+} // namespace execution
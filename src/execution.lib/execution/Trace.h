@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace execution {
+
+/// streams Chrome trace_event JSON, as shown by chrome://tracing and Perfetto
+///
+/// * spans are nested begin and end events of one thread
+/// * timestamps are microseconds since the trace started
+/// * the JSON is complete after finish or destruction
+struct Trace {
+    using This = Trace;
+    using Clock = std::chrono::steady_clock;
+
+    /// named argument of an event
+    struct Arg {
+        const char* name{};
+        std::string value{};
+    };
+    using Args = std::vector<Arg>;
+
+    explicit Trace(std::ostream& out);
+    ~Trace() { finish(); }
+
+    Trace(const This&) = delete;
+    auto operator=(const This&) -> This& = delete;
+
+    void begin(const char* category, const std::string& name, const Args& args = {});
+    void end();
+
+    /// value of a counter track
+    void counter(const char* name, uint64_t value);
+
+    void finish();
+
+private:
+    void event(char phase, const char* category, const std::string& name);
+
+    std::ostream* out{};
+    Clock::time_point start{};
+    size_t open{}; // spans that are not ended
+    bool first{true};
+    bool finished{};
+};
+
+/// ends a span when it leaves the scope, does nothing without a trace
+struct TraceSpan {
+    Trace* trace{};
+
+    TraceSpan() = default;
+    explicit TraceSpan(Trace* begun)
+        : trace(begun) {}
+    ~TraceSpan() {
+        if (trace) trace->end();
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    auto operator=(const TraceSpan&) -> TraceSpan& = delete;
+};
+
+} // namespace execution
@@ -0,0 +1,39 @@
+#include "execution/Trace.h"
+
+#include "gtest/gtest.h"
+
+#include <regex>
+#include <sstream>
+
+namespace {
+
+auto withoutTimestamps(const std::string& json) -> std::string {
+    return std::regex_replace(json, std::regex{R"(,"ts":[0-9.]+)"}, "");
+}
+
+} // namespace
+
+TEST(trace, spansAndCounters) {
+    auto out = std::stringstream{};
+    {
+        auto trace = execution::Trace{out};
+        trace.begin("compile", "file", {{"name", "a \"b\"\n"}});
+        trace.counter("stack", 42);
+        {
+            trace.begin("call", "f");
+            auto span = execution::TraceSpan{&trace};
+        }
+        trace.begin("parse", "block"); // ended by the destruction
+    }
+    EXPECT_EQ(
+        withoutTimestamps(out.str()),
+        "{\"traceEvents\":[\n"
+        "{\"ph\":\"B\",\"pid\":1,\"tid\":1,\"cat\":\"compile\",\"name\":\"file\",\"args\":{\"name\":\"a \\\"b\\\"\\n\"}},\n"
+        "{\"ph\":\"C\",\"pid\":1,\"tid\":1,\"name\":\"stack\",\"args\":{\"value\":42}},\n"
+        "{\"ph\":\"B\",\"pid\":1,\"tid\":1,\"cat\":\"call\",\"name\":\"f\"},\n"
+        "{\"ph\":\"E\",\"pid\":1,\"tid\":1},\n"
+        "{\"ph\":\"B\",\"pid\":1,\"tid\":1,\"cat\":\"parse\",\"name\":\"block\"},\n"
+        "{\"ph\":\"E\",\"pid\":1,\"tid\":1},\n"
+        "{\"ph\":\"E\",\"pid\":1,\"tid\":1}\n"
+        "]}\n");
+}
@@ -0,0 +1,251 @@
+#include "VM.h"
+
+#include <cassert>
+#include <new>
+#include <vector>
+
+// threaded dispatch uses the labels as values extension, the pedantic warnings are silenced around it
+#if defined(__clang__)
+#    define EXECUTION_COMPUTED_GOTO
+#    define EXECUTION_COMPUTED_GOTO_BEGIN                                                                             \
+        _Pragma("clang diagnostic push") _Pragma("clang diagnostic ignored \"-Wgnu-label-as-value\"")
+#    define EXECUTION_COMPUTED_GOTO_END _Pragma("clang diagnostic pop")
+#elif defined(__GNUC__)
+#    define EXECUTION_COMPUTED_GOTO
+#    define EXECUTION_COMPUTED_GOTO_BEGIN                                                                             \
+        _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wpedantic\"")
+#    define EXECUTION_COMPUTED_GOTO_END _Pragma("GCC diagnostic pop")
+#endif
+
+namespace execution {
+
+namespace {
+
+using namespace bytecode;
+
+/// running function, the control stack replaces the native stack
+struct Control {
+    const Program* program{};
+    const Instruction* ip{}; // continuation after the running callee returns
+    Byte* frame{};
+    Stack::Ptr frameData{};
+    instance::FunctionView function{};
+};
+
+/// entered callee, that still receives its arguments
+struct Pending {
+    const Program* program{};
+    Byte* frame{};
+    Stack::Ptr frameData{};
+    instance::FunctionView function{};
+    size_t controlDepth{}; // controls below the frame, the controls above it were allocated later
+};
+
+struct Run {
+    Context& context;
+    IntrinsicContext intrinsicContext;
+    std::vector<Control> controls{};
+    std::vector<Pending> pendings{};
+
+    explicit Run(Context& context)
+        : context(context)
+        , intrinsicContext(context, nullptr) {}
+
+    ~Run() { unwind(); }
+
+    void run(const Program& entry, Byte* entryFrame) {
+        auto* compiler = context.compiler;
+        const auto* program = &entry;
+        const auto* ip = program->instructions.data();
+        auto* frame = entryFrame;
+        controls.push_back(Control{program, nullptr, frame, {}, nullptr});
+
+        auto invokeCallee = [&](const CallSite& site) {
+            if (!compiler->step([&] { return callChain(site.function); })) return;
+            auto pending = std::move(pendings.back());
+            pendings.pop_back();
+            if (auto exec = site.function->body.intrinsic; exec) {
+                auto profile = ProfileCall{compiler->profiler, site.function, compiler->stack.used()};
+                if (profile.profiler) profile.profiler->intrinsic();
+                auto span = compiler->traceCall(*site.function);
+                exec(pending.frame, &intrinsicContext);
+                destruct(*pending.program, pending.frame);
+                return;
+            }
+            if (controls.size() > compiler->callDepthLimit) {
+                pendings.push_back(std::move(pending));
+                return callDepthExceeded();
+            }
+            controls.back().ip = ip;
+            program = pending.program;
+            ip = program->instructions.data();
+            frame = pending.frame;
+            controls.push_back(Control{program, nullptr, frame, std::move(pending.frameData), pending.function});
+            if (auto* profiler = compiler->profiler; profiler) profiler->enter(pending.function, compiler->stack.used());
+            if (compiler->trace) compiler->beginTrace(*pending.function);
+        };
+        // returns false once the entry program returned
+        auto returnToCaller = [&] {
+            destruct(*program, frame);
+            popControl();
+            if (controls.empty()) return false;
+            const auto& caller = controls.back();
+            program = caller.program;
+            ip = caller.ip;
+            frame = caller.frame;
+            return true;
+        };
+
+#ifdef EXECUTION_COMPUTED_GOTO
+        EXECUTION_COMPUTED_GOTO_BEGIN
+        static void* const dispatch[] = {&&callIntrinsic, &&enter, &&store, &&invoke, &&ret};
+#    define EXECUTION_NEXT() goto* dispatch[static_cast<int>((ip++)->op)]
+        EXECUTION_NEXT();
+    callIntrinsic : {
+        if (!compiler->step([&] { return callChain(); })) return;
+        if (auto* profiler = compiler->profiler; profiler) profiler->intrinsic();
+        const auto& site = program->intrinsics[ip[-1].index];
+        {
+            auto span = compiler->traceIntrinsic();
+            site.exec(frame + site.memory, &intrinsicContext);
+        }
+        if (compiler->aborted) return;
+        EXECUTION_NEXT();
+    }
+    enter:
+        enterCall(program->calls[ip[-1].index]);
+        if (compiler->aborted) return;
+        EXECUTION_NEXT();
+    store:
+        runStore(program->stores[ip[-1].index], frame);
+        EXECUTION_NEXT();
+    invoke:
+        invokeCallee(program->calls[ip[-1].index]);
+        if (compiler->aborted) return;
+        EXECUTION_NEXT();
+    ret:
+        if (!returnToCaller()) return;
+        EXECUTION_NEXT();
+#    undef EXECUTION_NEXT
+        EXECUTION_COMPUTED_GOTO_END
+#else
+        while (true) {
+            const auto& instruction = *ip++;
+            switch (instruction.op) {
+            case Op::callIntrinsic: {
+                if (!compiler->step([&] { return callChain(); })) return;
+                if (auto* profiler = compiler->profiler; profiler) profiler->intrinsic();
+                const auto& site = program->intrinsics[instruction.index];
+                auto span = compiler->traceIntrinsic();
+                site.exec(frame + site.memory, &intrinsicContext);
+                break;
+            }
+            case Op::enter: enterCall(program->calls[instruction.index]); break;
+            case Op::store: runStore(program->stores[instruction.index], frame); break;
+            case Op::invoke: invokeCallee(program->calls[instruction.index]); break;
+            case Op::ret:
+                if (!returnToCaller()) return;
+                break;
+            }
+            if (compiler->aborted) return;
+        }
+#endif
+    }
+
+    void enterCall(const CallSite& site) {
+        const auto& callee = VM::programFor(*site.function);
+        if (callee.unsupported) return context.compiler->unsupported(callee.unsupported, callChain(site.function));
+        auto frameData = context.compiler->stack.allocate(callee.frameSize);
+        if (!frameData) return stackOverflow(site.function);
+        auto* frame = frameData.get();
+        pendings.push_back(Pending{&callee, frame, std::move(frameData), site.function, controls.size()});
+    }
+
+    void runStore(const Store& store, Byte* frame) {
+        auto* target = store.target == StoreTarget::callee ? pendings.back().frame : frame;
+        auto* destination = target + store.destination;
+        switch (store.kind) {
+        case StoreKind::copyValue: parser::cloneValue(*store.type, destination, store.constant); break;
+        case StoreKind::copySlot: parser::cloneValue(*store.type, destination, frame + store.source); break;
+        case StoreKind::valueAddress: reinterpret_cast<const void*&>(*destination) = store.constant; break;
+        case StoreKind::slotAddress: reinterpret_cast<void*&>(*destination) = frame + store.source; break;
+        case StoreKind::outerCalleeAddress:
+            reinterpret_cast<void*&>(*destination) = pendings[pendings.size() - 2].frame + store.source;
+            break;
+        case StoreKind::copyTuple:
+            new (destination) parser::NameTypeValueTuple(*static_cast<const parser::NameTypeValueTuple*>(store.constant));
+            break;
+        }
+    }
+
+    static void destruct(const Program& program, Byte* frame) {
+        for (const auto& destruct : program.destructs) destruct.type->destructFunc(frame + destruct.offset);
+    }
+
+    // innermost first
+    auto callChain(instance::FunctionView callee = {}) const -> CallChain {
+        auto chain = CallChain{};
+        chain.reserve(controls.size() + 1);
+        if (callee) chain.push_back(callee);
+        for (auto it = controls.rbegin(); it != controls.rend(); ++it) {
+            if (it->function) chain.push_back(it->function);
+        }
+        auto outer = context.callChain();
+        chain.insert(chain.end(), outer.begin(), outer.end());
+        return chain;
+    }
+
+    void stackOverflow(instance::FunctionView callee) { context.compiler->stackOverflow(callChain(callee)); }
+    void callDepthExceeded() {
+        context.compiler->callDepthExceeded(callChain(pendings.back().function));
+    }
+
+    // note: frames of an aborted execution are not destructed, it is unknown which values were constructed
+    // releases the frames in reverse order of their allocation
+    void unwind() {
+        while (!pendings.empty()) {
+            while (controls.size() > pendings.back().controlDepth) popControl();
+            pendings.pop_back();
+        }
+        while (!controls.empty()) popControl();
+    }
+
+    void popControl() {
+        if (auto* profiler = context.compiler->profiler; profiler && controls.back().function) profiler->leave();
+        if (auto* trace = context.compiler->trace; trace && controls.back().function) trace->end();
+        controls.pop_back();
+    }
+};
+
+// runs a program without arguments, its frame holds the variables and the dropped results
+void runEntry(const Program& program, const Context& context) {
+    auto* compiler = context.compiler;
+    if (program.unsupported) return compiler->unsupported(program.unsupported, context.callChain());
+    auto frameData = compiler->stack.allocate(program.frameSize);
+    if (!frameData) return compiler->stackOverflow(context.callChain());
+    auto entryContext = context.createCall();
+    Run{entryContext}.run(program, frameData.get());
+}
+
+} // namespace
+
+void VM::runCall(const parser::Call& call, const Context& context) {
+    if (call.function->body.intrinsic) return Machine::runCall(call, context); // note: nothing to lower
+    if (context.compiler->aborted) return;
+    auto program = compileCall(call); // note: the arguments live only during this call
+    runEntry(*program, context);
+}
+
+void VM::runBlock(const parser::Block& block, const Context& context) {
+    if (context.compiler->aborted) return;
+    auto program = compileBlock(block);
+    runEntry(*program, context);
+}
+
+auto VM::programFor(const instance::Function& function) -> const bytecode::Program& {
+    auto& executable = function.body.executable;
+    if (!executable) executable = compileFunction(function);
+    return *static_cast<const Program*>(executable.get());
+}
+
+} // namespace execution
@@ -0,0 +1,21 @@
+#pragma once
+#include "execution/Bytecode.h"
+#include "execution/Machine.h"
+
+namespace execution {
+
+/// executes functions lowered to bytecode
+///
+/// * each function is lowered once, the program is cached on its body
+/// * one stack allocation per call holds arguments and all variables
+/// * calls run on an explicit control stack, the native stack does not grow with the recursion
+/// note: the cache is not synchronised, run it from one thread at a time
+struct VM {
+    static void runCall(const parser::Call& call, const Context& context);
+    static void runBlock(const parser::Block& block, const Context& context);
+
+    /// the cached program of the function, lowered on first use
+    static auto programFor(const instance::Function& function) -> const bytecode::Program&;
+};
+
+} // namespace execution
@@ -0,0 +1,452 @@
+#include "execution/VM.h"
+
+#include "instance/Function.builder.h"
+#include "instance/Scope.builder.h"
+#include "instance/Type.builder.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// compares the VM against the tree walking Machine
+struct Differential {
+    instance::Scope scope{};
+    parser::TypeView u64{};
+    instance::FunctionView print{};
+    instance::FunctionView twice{};
+    std::vector<std::unique_ptr<instance::Function>> functions{};
+
+    inline static std::string trace{};
+
+    static void printImpl(uint8_t* memory, intrinsic::Context*) {
+        trace += std::to_string(*reinterpret_cast<uint64_t*>(memory)) + ' ';
+    }
+    static void twiceImpl(uint8_t* memory, intrinsic::Context*) {
+        auto* result = *reinterpret_cast<uint64_t**>(memory + sizeof(uint64_t));
+        *result = 2 * *reinterpret_cast<uint64_t*>(memory);
+    }
+
+    Differential() {
+        instance::buildScope(
+            scope,
+            instance::typeModT<uint64_t>("u64"),
+            instance::fun("print").params(instance::param("v").right().type(parser::type("u64"))).rawIntrinsic(&printImpl),
+            instance::fun("twice")
+                .params(
+                    instance::param("v").right().type(parser::type("u64")),
+                    instance::param("r").result().type(parser::type("u64")))
+                .rawIntrinsic(&twiceImpl));
+        u64 = parser::type("u64").build(scope);
+        print = &instance::lookupA<instance::Function>(scope, instance::NameView{"print"});
+        twice = &instance::lookupA<instance::Function>(scope, instance::NameView{"twice"});
+    }
+
+    auto value(uint64_t v) const -> parser::Node {
+        auto value = parser::Value{u64};
+        value.set<uint64_t>() = v;
+        return value;
+    }
+
+    static auto call(instance::FunctionView function, parser::Node argument) -> parser::Call {
+        auto assign = parser::ArgumentAssignment{};
+        assign.parameter = function->parameters.front();
+        assign.values.push_back(std::move(argument));
+        auto call = parser::Call{};
+        call.function = function;
+        call.arguments.push_back(std::move(assign));
+        return call;
+    }
+
+    auto function(instance::details::FunctionBuilder&& builder) -> instance::Function& {
+        return *functions.emplace_back(std::make_unique<instance::Function>(std::move(builder).build(scope)));
+    }
+
+    auto variable(instance::Function& function) -> instance::VariableView {
+        auto variable = instance::Variable{};
+        variable.typed.name = instance::Name{"b"};
+        variable.typed.type = u64;
+        return &function.body.locals.emplace(std::move(variable))->get<instance::Variable>();
+    }
+
+    static auto parameter(const instance::Function& function) -> parser::Node {
+        return parser::ParameterReference{function.parameters.front()};
+    }
+
+    template<class Run>
+    auto traceOf(Run&& run) -> std::string {
+        auto compiler = execution::Compiler{};
+        auto context = execution::Context{};
+        context.compiler = &compiler;
+        trace.clear();
+        run(context);
+        return trace;
+    }
+
+    void expectSame(const parser::Call& call, const std::string& expected) {
+        auto machine = traceOf([&](auto& context) { execution::Machine::runCall(call, context); });
+        auto vm = traceOf([&](auto& context) { execution::VM::runCall(call, context); });
+        EXPECT_EQ(machine, expected);
+        EXPECT_EQ(vm, machine);
+    }
+};
+
+/// counts the living instances
+struct Counted {
+    inline static int alive{};
+
+    Counted() { alive++; }
+    Counted(const Counted&) { alive++; }
+    ~Counted() { alive--; }
+    auto operator=(const Counted&) -> Counted& = default;
+
+    bool operator==(const Counted&) const { return true; }
+};
+
+} // namespace
+
+TEST(vm, intrinsicCall) {
+    auto data = Differential{};
+    ASSERT_NE(data.print->body.intrinsic, nullptr);
+    data.expectSame(Differential::call(data.print, data.value(42)), "42 ");
+}
+
+TEST(vm, parametersVariablesAndBlocks) {
+    auto data = Differential{};
+    auto& show = data.function(instance::fun("show").params(instance::param("a").right().type(parser::type("u64"))));
+    auto b = data.variable(show);
+
+    auto init = parser::VariableInit{};
+    init.variable = b;
+    init.nodes.push_back(Differential::call(data.twice, Differential::parameter(show)));
+    show.body.block.nodes.push_back(std::move(init));
+    show.body.block.nodes.push_back(Differential::call(data.print, parser::VariableReference{b}));
+    auto nested = parser::Block{};
+    nested.nodes.push_back(Differential::call(data.print, Differential::parameter(show)));
+    show.body.block.nodes.push_back(std::move(nested));
+    show.body.block.nodes.push_back(Differential::call(data.print, data.value(7)));
+    execution::resolveSlots(show);
+
+    data.expectSame(Differential::call(&show, data.value(5)), "10 5 7 ");
+    data.expectSame(Differential::call(&show, data.value(1)), "2 1 7 "); // cached program
+}
+
+TEST(vm, nestedUserCalls) {
+    auto data = Differential{};
+    auto& inner = data.function(instance::fun("inner").params(instance::param("x").right().type(parser::type("u64"))));
+    inner.body.block.nodes.push_back(Differential::call(data.print, Differential::parameter(inner)));
+
+    auto& outer = data.function(instance::fun("outer").params(instance::param("y").right().type(parser::type("u64"))));
+    outer.body.block.nodes.push_back(
+        Differential::call(&inner, Differential::call(data.twice, Differential::parameter(outer))));
+    outer.body.block.nodes.push_back(Differential::call(&inner, Differential::parameter(outer)));
+    execution::resolveSlots(inner);
+    execution::resolveSlots(outer);
+
+    ASSERT_EQ(outer.body.intrinsic, nullptr);
+    data.expectSame(Differential::call(&outer, data.value(3)), "6 3 ");
+}
+
+TEST(vm, droppedResult) {
+    auto data = Differential{};
+    auto& twiceAndPrint = data.function(instance::fun("twiceAndPrint")
+                                            .params(
+                                                instance::param("v").right().type(parser::type("u64")),
+                                                instance::param("r").result().type(parser::type("u64"))));
+    twiceAndPrint.body.block.nodes.push_back(Differential::call(data.twice, Differential::parameter(twiceAndPrint)));
+    twiceAndPrint.body.block.nodes.push_back(Differential::call(data.print, Differential::parameter(twiceAndPrint)));
+    execution::prepareBody(twiceAndPrint);
+    auto call = Differential::call(&twiceAndPrint, data.value(3)); // note: no argument receives the result
+
+    auto runDropping = [&](auto run) {
+        auto compiler = execution::Compiler{};
+        auto context = execution::Context{};
+        context.compiler = &compiler;
+        Differential::trace.clear();
+        run(call, context);
+        EXPECT_FALSE(compiler.aborted);
+        EXPECT_EQ(Differential::trace, "3 ");
+        EXPECT_EQ(compiler.stack.used(), 0u);
+    };
+    runDropping([](auto& call, auto& context) { execution::Machine::runCall(call, context); });
+    runDropping([](auto& call, auto& context) { execution::VM::runCall(call, context); });
+}
+
+TEST(vm, firstAssignmentWins) {
+    auto data = Differential{};
+    auto& wrap = data.function(instance::fun("wrap").params(instance::param("x").right().type(parser::type("u64"))));
+    wrap.body.block.nodes.push_back(Differential::call(data.print, Differential::parameter(wrap)));
+    execution::prepareBody(wrap);
+
+    auto call = Differential::call(&wrap, data.value(1));
+    auto second = parser::ArgumentAssignment{};
+    second.parameter = wrap.parameters.front();
+    second.values.push_back(data.value(2));
+    call.arguments.push_back(std::move(second));
+    data.expectSame(call, "1 ");
+}
+
+TEST(vm, unsupportedReference) {
+    auto data = Differential{};
+    auto& holder = data.function(instance::fun("holder"));
+    auto b = data.variable(holder);
+    auto& reader = data.function(instance::fun("reader"));
+    reader.body.block.nodes.push_back(Differential::call(data.print, parser::VariableReference{b}));
+    execution::prepareBody(reader);
+
+    auto diagnostics = diagnostic::Diagnostics{};
+    auto compiler = execution::Compiler{};
+    compiler.reportDiagnostic = [&](diagnostic::Diagnostic d) { diagnostics.push_back(std::move(d)); };
+    auto context = execution::Context{};
+    context.compiler = &compiler;
+    auto call = parser::Call{};
+    call.function = &reader;
+    execution::VM::runCall(call, context);
+
+    EXPECT_TRUE(compiler.aborted);
+    ASSERT_EQ(diagnostics.size(), 1u);
+    EXPECT_EQ(diagnostics.front().code.number, 4u);
+    EXPECT_EQ(compiler.stack.used(), 0u);
+}
+
+TEST(vm, block) {
+    auto data = Differential{};
+    auto& holder = data.function(instance::fun("holder"));
+    auto b = data.variable(holder);
+
+    auto block = parser::Block{};
+    auto init = parser::VariableInit{};
+    init.variable = b;
+    init.nodes.push_back(data.value(11));
+    block.nodes.push_back(std::move(init));
+    block.nodes.push_back(Differential::call(data.print, parser::VariableReference{b}));
+    execution::resolveSlots(block);
+
+    auto machine = data.traceOf([&](auto& context) { execution::Machine::runBlock(block, context); });
+    auto vm = data.traceOf([&](auto& context) { execution::VM::runBlock(block, context); });
+    EXPECT_EQ(machine, "11 ");
+    EXPECT_EQ(vm, machine);
+}
+
+TEST(vm, stackOverflow) {
+    auto data = Differential{};
+    auto& deep = data.function(instance::fun("deep").params(instance::param("a").right().type(parser::type("u64"))));
+    auto b = data.variable(deep);
+    auto init = parser::VariableInit{};
+    init.variable = b;
+    init.nodes.push_back(Differential::call(data.twice, Differential::parameter(deep)));
+    deep.body.block.nodes.push_back(std::move(init));
+    deep.body.block.nodes.push_back(Differential::call(data.print, parser::VariableReference{b}));
+    execution::resolveSlots(deep);
+    auto call = Differential::call(&deep, data.value(5));
+
+    auto runWithSmallStack = [&](auto run) {
+        auto diagnostics = diagnostic::Diagnostics{};
+        auto compiler = execution::Compiler{};
+        compiler.stack = execution::Stack{16, 16};
+        compiler.reportDiagnostic = [&](diagnostic::Diagnostic d) { diagnostics.push_back(std::move(d)); };
+        auto context = execution::Context{};
+        context.compiler = &compiler;
+        Differential::trace.clear();
+        run(call, context);
+
+        EXPECT_TRUE(compiler.aborted);
+        ASSERT_EQ(diagnostics.size(), 1u);
+        EXPECT_EQ(diagnostics.front().code.number, 1u);
+        EXPECT_EQ(Differential::trace, "");
+        EXPECT_EQ(compiler.stack.used(), 0u);
+    };
+    runWithSmallStack([](auto& call, auto& context) { execution::Machine::runCall(call, context); });
+    runWithSmallStack([](auto& call, auto& context) { execution::VM::runCall(call, context); });
+}
+
+TEST(vm, destructsFrameValues) {
+    auto data = Differential{};
+    instance::buildScope(
+        data.scope,
+        instance::typeModT<Counted>("counted"),
+        instance::fun("look")
+            .params(instance::param("c").right().type(parser::type("counted")))
+            .rawIntrinsic([](uint8_t*, intrinsic::Context*) {}));
+    auto counted = parser::type("counted").build(data.scope);
+    auto look = &instance::lookupA<instance::Function>(data.scope, instance::NameView{"look"});
+
+    auto& keep = data.function(instance::fun("keep").params(instance::param("c").right().type(parser::type("counted"))));
+    auto variable = instance::Variable{};
+    variable.typed.name = instance::Name{"v"};
+    variable.typed.type = counted;
+    auto v = &keep.body.locals.emplace(std::move(variable))->get<instance::Variable>();
+    auto init = parser::VariableInit{};
+    init.variable = v;
+    init.nodes.push_back(Differential::parameter(keep));
+    keep.body.block.nodes.push_back(std::move(init));
+    keep.body.block.nodes.push_back(Differential::call(look, parser::VariableReference{v}));
+    execution::resolveSlots(keep);
+
+    auto value = parser::Value{counted};
+    auto call = Differential::call(&keep, std::move(value));
+
+    auto before = Counted::alive;
+    data.traceOf([&](auto& context) { execution::Machine::runCall(call, context); });
+    EXPECT_EQ(Counted::alive, before);
+    data.traceOf([&](auto& context) { execution::VM::runCall(call, context); });
+    EXPECT_EQ(Counted::alive, before);
+}
+
+TEST(vm, deepRecursion) {
+    auto data = Differential{};
+    auto& recurse = data.function(instance::fun("recurse").params(instance::param("a").right().type(parser::type("u64"))));
+    recurse.body.block.nodes.push_back(Differential::call(&recurse, Differential::parameter(recurse)));
+    execution::prepareBody(recurse);
+
+    auto diagnostics = diagnostic::Diagnostics{};
+    auto compiler = execution::Compiler{};
+    compiler.callDepthLimit = 1'000'000;
+    compiler.reportDiagnostic = [&](diagnostic::Diagnostic d) { diagnostics.push_back(std::move(d)); };
+    auto context = execution::Context{};
+    context.compiler = &compiler;
+
+    execution::VM::runCall(Differential::call(&recurse, data.value(1)), context);
+
+    EXPECT_TRUE(compiler.aborted);
+    ASSERT_EQ(diagnostics.size(), 1u);
+    EXPECT_EQ(diagnostics.front().code.number, 2u);
+    EXPECT_GT(compiler.stack.stats().highWaterMark, 1'000'000u);
+    EXPECT_EQ(compiler.stack.used(), 0u);
+}
+
+TEST(vm, abortInNestedArgument) {
+    auto data = Differential{};
+    auto& outer = data.function(instance::fun("outer").params(instance::param("y").right().type(parser::type("u64"))));
+    auto& recurse = data.function(instance::fun("recurse").params(
+        instance::param("a").right().type(parser::type("u64")),
+        instance::param("r").result().type(parser::type("u64"))));
+    // each level enters outer before the argument calls recurse, the frames of both kinds interleave
+    recurse.body.block.nodes.push_back(
+        Differential::call(&outer, Differential::call(&recurse, Differential::parameter(recurse))));
+    execution::prepareBody(outer);
+    execution::prepareBody(recurse);
+
+    auto diagnostics = diagnostic::Diagnostics{};
+    auto compiler = execution::Compiler{};
+    compiler.callDepthLimit = 10;
+    compiler.stack = execution::Stack{64, 1'000'000}; // note: small segments, the frames span several of them
+    compiler.reportDiagnostic = [&](diagnostic::Diagnostic d) { diagnostics.push_back(std::move(d)); };
+    auto context = execution::Context{};
+    context.compiler = &compiler;
+
+    execution::VM::runCall(Differential::call(&recurse, data.value(1)), context);
+
+    EXPECT_TRUE(compiler.aborted);
+    ASSERT_EQ(diagnostics.size(), 1u);
+    EXPECT_EQ(diagnostics.front().code.number, 2u);
+    EXPECT_EQ(compiler.stack.used(), 0u);
+}
+
+TEST(vm, stepBudget) {
+    auto data = Differential{};
+    auto& recurse = data.function(instance::fun("recurse").params(instance::param("a").right().type(parser::type("u64"))));
+    recurse.body.block.nodes.push_back(Differential::call(data.print, Differential::parameter(recurse)));
+    recurse.body.block.nodes.push_back(Differential::call(&recurse, Differential::parameter(recurse)));
+    execution::prepareBody(recurse);
+    auto call = Differential::call(&recurse, data.value(3));
+
+    auto runWithBudget = [&](auto run) {
+        auto diagnostics = diagnostic::Diagnostics{};
+        auto progress = std::vector<uint64_t>{};
+        auto compiler = execution::Compiler{};
+        compiler.stepLimit = 10;
+        compiler.stepBudgetExhausted = [&](const execution::StepProgress& p) -> uint64_t {
+            EXPECT_EQ(p.chain.back(), &recurse);
+            progress.push_back(p.steps);
+            return progress.size() < 3 ? 10 : 0;
+        };
+        compiler.reportDiagnostic = [&](diagnostic::Diagnostic d) { diagnostics.push_back(std::move(d)); };
+        auto context = execution::Context{};
+        context.compiler = &compiler;
+        run(call, context);
+
+        EXPECT_TRUE(compiler.aborted);
+        EXPECT_EQ(progress, (std::vector<uint64_t>{10, 20, 30}));
+        ASSERT_EQ(diagnostics.size(), 1u);
+        EXPECT_EQ(diagnostics.front().code.number, 3u);
+        EXPECT_EQ(compiler.stack.used(), 0u);
+    };
+    runWithBudget([](auto& call, auto& context) { execution::Machine::runCall(call, context); });
+    runWithBudget([](auto& call, auto& context) { execution::VM::runCall(call, context); });
+}
+
+TEST(vm, profiler) {
+    auto data = Differential{};
+    auto& inner = data.function(instance::fun("inner").params(instance::param("x").right().type(parser::type("u64"))));
+    inner.body.block.nodes.push_back(Differential::call(data.print, Differential::parameter(inner)));
+    auto& outer = data.function(instance::fun("outer").params(instance::param("y").right().type(parser::type("u64"))));
+    outer.body.block.nodes.push_back(Differential::call(&inner, Differential::parameter(outer)));
+    outer.body.block.nodes.push_back(Differential::call(&inner, Differential::parameter(outer)));
+    execution::prepareBody(inner);
+    execution::prepareBody(outer);
+    auto call = Differential::call(&outer, data.value(3));
+
+    auto callsOf = [&](auto run) {
+        auto profiler = execution::Profiler{};
+        auto compiler = execution::Compiler{};
+        compiler.profiler = &profiler;
+        auto context = execution::Context{};
+        context.compiler = &compiler;
+        run(call, context);
+
+        auto calls = std::map<std::string, uint64_t>{};
+        for (const auto& profile : profiler.profiles()) {
+            const auto& name = profile.function->name;
+            calls[std::string(name.begin(), name.end())] = profile.calls;
+            if (profile.function == data.print) {
+                EXPECT_EQ(profile.intrinsics, 2u);
+            }
+        }
+        return calls;
+    };
+    auto machine = callsOf([](auto& call, auto& context) { execution::Machine::runCall(call, context); });
+    auto vm = callsOf([](auto& call, auto& context) { execution::VM::runCall(call, context); });
+    EXPECT_EQ(machine, (std::map<std::string, uint64_t>{{"inner", 2}, {"outer", 1}, {"print", 2}}));
+    EXPECT_EQ(vm, machine);
+}
+
+TEST(vm, trace) {
+    auto data = Differential{};
+    auto& inner = data.function(instance::fun("inner").params(instance::param("x").right().type(parser::type("u64"))));
+    inner.body.block.nodes.push_back(Differential::call(data.print, Differential::parameter(inner)));
+    auto& outer = data.function(instance::fun("outer").params(instance::param("y").right().type(parser::type("u64"))));
+    outer.body.block.nodes.push_back(Differential::call(&inner, Differential::parameter(outer)));
+    execution::prepareBody(inner);
+    execution::prepareBody(outer);
+    auto call = Differential::call(&outer, data.value(3));
+
+    auto spansOf = [&](auto run) {
+        auto out = std::stringstream{};
+        {
+            auto trace = execution::Trace{out};
+            auto compiler = execution::Compiler{};
+            compiler.trace = &trace;
+            auto context = execution::Context{};
+            context.compiler = &compiler;
+            run(call, context);
+        }
+        auto spans = std::string{};
+        for (auto line = std::string{}; std::getline(out, line);) {
+            if (line.find("\"ph\":\"E\"") != std::string::npos) spans += ')';
+            if (line.find("\"ph\":\"B\"") == std::string::npos) continue;
+            auto name = line.find("\"name\":\"") + 8;
+            spans += line.substr(name, line.find('"', name) - name) + '(';
+        }
+        return spans;
+    };
+    auto machine = spansOf([](auto& call, auto& context) { execution::Machine::runCall(call, context); });
+    auto vm = spansOf([](auto& call, auto& context) { execution::VM::runCall(call, context); });
+    EXPECT_EQ(machine, "outer(inner(print()))");
+    EXPECT_EQ(vm, machine);
+}
@@ -1,15 +1,34 @@
 #pragma once
 #include "LocalScope.h"
 
+#include "meta/Arena.h"
 #include "parser/Tree.h"
 
+#include <memory>
+
 namespace instance {
 
 using parser::Block;
 
 struct Body {
+    std::shared_ptr<meta::Arena> arena{}; // owns the nodes of locals and block, declared first to outlive them
     LocalScope locals{};
     Block block{};
+
+    /// set if the block is a single intrinsic call, allows the execution to call it directly
+    /// note: call updateIntrinsic() after the block changed
+    parser::IntrinsicCall::Exec intrinsic{};
+
+    void updateIntrinsic() {
+        const auto& nodes = block.nodes;
+        intrinsic = nodes.size() == 1 && nodes.front().holds<parser::IntrinsicCall>()
+            ? nodes.front().get<parser::IntrinsicCall>().exec
+            : nullptr;
+    }
+
+    /// lowered block for the execution, created on the first call
+    /// note: reset it whenever the block changes
+    mutable std::shared_ptr<const void> executable{};
 };
 
 } // namespace instance
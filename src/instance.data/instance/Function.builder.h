@@ -41,11 +41,13 @@ struct FunctionBuilder {
 
     auto rawIntrinsic(void (*f)(uint8_t*, intrinsic::Context*)) && -> This {
         fun_.body.block.nodes.emplace_back(parser::IntrinsicCall{f});
+        fun_.body.updateIntrinsic();
         return std::move(*this);
     }
 
     auto build(const Scope& scope) && -> Function {
         for (auto&& a : params_) fun_.parameters.emplace_back(std::move(a).build(scope, fun_.parameterScope));
+        fun_.updateParameterLayout();
         return std::move(fun_);
     }
 };
@@ -5,9 +5,29 @@
 namespace instance {
 
 auto Function::lookupParameter(NameView name) const -> OptParameterView {
-    auto r = parameterScope[name];
-    if (!r.single()) return {};
-    return &r.frontValue().get(meta::type<Parameter>);
+    const auto& byName = parameterLayout.byName;
+    if (auto it = byName.find(name); it != byName.end() && it->second != nullptr) return it->second;
+    return {};
+}
+
+void Function::updateParameterLayout() {
+    auto index = [&](auto it) -> size_t { return it - parameters.begin(); };
+    auto sideRange = [&](ParameterSide side, size_t& b, size_t& e) {
+        auto bIt = meta::findIf(parameters, [&](const auto a) { return a->side == side; });
+        auto eIt = std::find_if(bIt, parameters.cend(), [&](const auto a) { return a->side != side; });
+        b = index(bIt);
+        e = index(eIt);
+    };
+    auto& layout = parameterLayout;
+    layout.leftEnd = index(meta::findIf(parameters, [](const auto a) { return a->side != ParameterSide::left; }));
+    sideRange(ParameterSide::right, layout.rightBegin, layout.rightEnd);
+    sideRange(ParameterSide::result, layout.resultBegin, layout.resultEnd);
+
+    layout.byName.clear();
+    for (auto* parameter : parameters) {
+        auto [it, inserted] = layout.byName.emplace(nameOf(*parameter), parameter);
+        if (!inserted) it->second = nullptr;
+    }
 }
 
 } // namespace instance
@@ -12,6 +12,7 @@
 #include "strings/View.h"
 
 #include <set>
+#include <unordered_map>
 
 namespace instance {
 
@@ -30,6 +31,17 @@ using OptParameterView = meta::Optional<meta::DefaultPacked<ParameterView>>;
 
 using ParameterViews = std::vector<ParameterView>;
 using ParameterRange = meta::VectorRange<ParameterView const>;
+using ParameterByName = std::unordered_map<strings::CompareView, ParameterView>;
+
+/// precomputed spans into Function::parameters and an index of unique parameter names
+struct ParameterLayout {
+    size_t leftEnd{};
+    size_t rightBegin{};
+    size_t rightEnd{};
+    size_t resultBegin{};
+    size_t resultEnd{};
+    ParameterByName byName{}; // nullptr marks ambiguous names
+};
 
 struct Function {
     Name name{};
@@ -38,20 +50,25 @@ struct Function {
     Body body{};
     LocalScope parameterScope{};
     ParameterViews parameters{};
+    ParameterLayout parameterLayout{}; // call updateParameterLayout() after parameters changed
 
     auto lookupParameter(NameView name) const -> OptParameterView;
-    auto leftParameters() const -> ParameterRange {
-        auto b = parameters.begin();
-        auto e = meta::findIf(parameters, [](const auto& a) { return a->side != ParameterSide::left; });
-        return {b, e};
-    }
+    auto leftParameters() const -> ParameterRange { return parameterRange(0, parameterLayout.leftEnd); }
     auto rightParameters() const -> ParameterRange {
-        auto b = meta::findIf(parameters, [](const auto a) { return a->side == ParameterSide::right; });
-        auto e = std::find_if(b, parameters.end(), [](const auto a) { return a->side != ParameterSide::right; });
-        return {b, e};
+        return parameterRange(parameterLayout.rightBegin, parameterLayout.rightEnd);
+    }
+    auto resultParameters() const -> ParameterRange {
+        return parameterRange(parameterLayout.resultBegin, parameterLayout.resultEnd);
     }
     void orderParameters() {
         meta::stableSort(parameters, [](const auto a, const auto b) { return a->side < b->side; });
+        updateParameterLayout();
+    }
+    void updateParameterLayout();
+
+private:
+    auto parameterRange(size_t b, size_t e) const -> ParameterRange {
+        return {parameters.begin() + b, parameters.begin() + e};
     }
 };
 
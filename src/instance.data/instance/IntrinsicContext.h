@@ -18,6 +18,13 @@ struct Context {
 
     /// report diagnostics from the C++ API
     virtual void report(diagnostic::Diagnostic diagnostic) = 0;
+
+    /// parse the body of a declared function in parserScope
+    /// note: the compiler may defer the parsing until all declarations are known
+    virtual void parseBody(const parser::BlockLiteral& block, instance::Function& function) = 0;
+
+    /// notify the compiler about a new or redeclared function
+    virtual void declared(const instance::Function& function) = 0;
 };
 
 } // namespace intrinsic
@@ -2,6 +2,29 @@
 
 namespace instance {
 
-// empty
+auto Scope::operator[](NameView name) const& -> ConstEntryRange {
+    auto current = epoch->load(std::memory_order_relaxed);
+    if (cache.epoch != current) {
+        cache.ranges.clear();
+        cache.names.clear();
+        cache.epoch = current;
+    }
+    if (auto it = cache.ranges.find(strings::CompareView{name}); it != cache.ranges.end()) {
+        cache.stats.hits++;
+        return it->second;
+    }
+    cache.stats.misses++;
+    auto range = lookupChain(name);
+    const auto& owned = cache.names.emplace_back(name.begin(), name.end());
+    cache.ranges.emplace(strings::CompareView{owned}, range);
+    return range;
+}
+
+auto Scope::lookupChain(NameView name) const -> ConstEntryRange {
+    for (auto* scope = this;; scope = scope->parent) {
+        auto range = scope->locals[name];
+        if (!range.empty() || scope->parent == nullptr) return range;
+    }
+}
 
 } // namespace instance
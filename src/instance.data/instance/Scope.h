@@ -2,35 +2,105 @@
 #include "Entry.h"
 #include "LocalScope.h"
 
+#include "strings/View.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
 namespace instance {
 
+/// counters to tune the lookup cache
+struct ScopeLookupStats {
+    uint64_t hits{};
+    uint64_t misses{};
+};
+
+/// remembers results of lookups through the whole parent chain
+///
+/// note: the cached ranges may point to the end of a LocalScope, therefore we drop them on move
+struct ScopeLookupCache {
+    using This = ScopeLookupCache;
+    using RangeByName = std::unordered_map<strings::CompareView, ConstEntryRange>;
+
+    uint64_t epoch{}; // epoch of the scope chain, when the ranges were cached
+    RangeByName ranges{}; // note: keys view into names
+    std::deque<Name> names{}; // owns the names of all cached ranges
+    ScopeLookupStats stats{};
+
+    ScopeLookupCache() = default;
+    ~ScopeLookupCache() = default;
+
+    // move drops all cached ranges
+    ScopeLookupCache(This&& o) noexcept
+        : stats(o.stats) {}
+    auto operator=(This&& o) noexcept -> This& {
+        epoch = {};
+        ranges.clear();
+        names.clear();
+        stats = o.stats;
+        return *this;
+    }
+
+    // no copy
+    ScopeLookupCache(const This&) = delete;
+    auto operator=(const This&) -> This& = delete;
+};
+
+/// named entries with a lookup through all parent scopes
+///
+/// * a scope shares the epoch of its parent, every emplace in the chain advances it
+/// * lookups only modify the cache of the queried scope
+///
+/// note: threads may share parent scopes, as long as no shared scope in the chain is modified
 struct Scope {
     using This = Scope;
+    using Epoch = std::shared_ptr<std::atomic<uint64_t>>;
 
     const This* parent{};
-    LocalScope locals;
+    LocalScope locals; // note: direct modifications bypass the lookup cache
 
-    Scope() = default;
+    Scope()
+        : epoch(std::make_shared<std::atomic<uint64_t>>()) {}
     ~Scope() = default;
     explicit Scope(const This* parent)
-        : parent(parent) {}
+        : parent(parent)
+        , epoch(parent ? parent->epoch : std::make_shared<std::atomic<uint64_t>>()) {}
 
-    // move enabled
-    Scope(This&&) = default;
-    Scope& operator=(This&&) = default;
+    // move enabled, the moved from scope keeps the epoch
+    Scope(This&& o) noexcept
+        : parent(o.parent)
+        , locals(std::move(o.locals))
+        , epoch(o.epoch)
+        , cache(std::move(o.cache)) {}
+    Scope& operator=(This&& o) noexcept {
+        parent = o.parent;
+        locals = std::move(o.locals);
+        epoch = o.epoch;
+        cache = std::move(o.cache);
+        return *this;
+    }
 
     // no copy
     Scope(const This&) = delete;
     Scope& operator=(const This&) = delete;
 
 public:
-    auto operator[](NameView name) const& -> ConstEntryRange {
-        auto range = locals[name];
-        if (range.empty() && parent != nullptr) return (*parent)[name];
-        return range;
+    auto operator[](NameView name) const& -> ConstEntryRange;
+
+    auto emplace(Entry&& entry) & -> EntryView {
+        epoch->fetch_add(1, std::memory_order_relaxed);
+        return locals.emplace(std::move(entry));
     }
 
-    auto emplace(Entry&& entry) & -> EntryView { return locals.emplace(std::move(entry)); }
+    auto lookupStats() const -> const ScopeLookupStats& { return cache.stats; }
+
+private:
+    auto lookupChain(NameView name) const -> ConstEntryRange;
+
+    Epoch epoch; // shared by the whole chain
+    mutable ScopeLookupCache cache{};
 };
 
 } // namespace instance
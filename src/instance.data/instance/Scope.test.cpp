@@ -0,0 +1,63 @@
+#include "instance/Scope.builder.h"
+
+#include "gtest/gtest.h"
+
+using instance::Scope;
+using strings::View;
+
+TEST(scope, lookupParentChain) {
+    auto globals = Scope{};
+    instance::buildScope(globals, instance::fun("outer"));
+    auto inner = Scope{&globals};
+    instance::buildScope(inner, instance::fun("inner"));
+
+    ASSERT_TRUE(inner[View{"outer"}].single());
+    ASSERT_TRUE(inner[View{"inner"}].single());
+    ASSERT_TRUE(inner[View{"missing"}].empty());
+    ASSERT_TRUE(globals[View{"inner"}].empty());
+}
+
+TEST(scope, cacheHits) {
+    auto globals = Scope{};
+    instance::buildScope(globals, instance::fun("outer"));
+    auto inner = Scope{&globals};
+
+    auto first = inner[View{"outer"}];
+    auto second = inner[View{"outer"}];
+    ASSERT_EQ(&first.frontValue(), &second.frontValue());
+
+    EXPECT_EQ(inner.lookupStats().misses, 1u);
+    EXPECT_EQ(inner.lookupStats().hits, 1u);
+}
+
+TEST(scope, emplaceInvalidatesNestedCache) {
+    auto globals = Scope{};
+    auto inner = Scope{&globals};
+    ASSERT_TRUE(inner[View{"late"}].empty());
+
+    instance::buildScope(globals, instance::fun("late"));
+    ASSERT_TRUE(inner[View{"late"}].single());
+
+    instance::buildScope(inner, instance::fun("late"));
+    auto range = inner[View{"late"}];
+    ASSERT_TRUE(range.single()); // inner shadows globals
+    EXPECT_EQ(&range.frontValue(), &inner.locals[View{"late"}].frontValue());
+
+    EXPECT_EQ(inner.lookupStats().hits, 0u);
+    EXPECT_EQ(inner.lookupStats().misses, 3u);
+}
+
+TEST(scope, cacheOwnsNames) {
+    auto globals = Scope{};
+    instance::buildScope(globals, instance::fun("outer"));
+    auto inner = Scope{&globals};
+
+    {
+        auto name = std::string{"outer"};
+        auto view = View{name.data(), name.data() + name.size()};
+        ASSERT_TRUE(inner[view].single());
+        name = "other";
+    }
+    ASSERT_TRUE(inner[View{"outer"}].single());
+    EXPECT_EQ(inner.lookupStats().hits, 1u);
+}
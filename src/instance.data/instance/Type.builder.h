@@ -39,16 +39,28 @@ struct TypeModuleBuilder {
         type_.cloneFunc = f;
         return std::move(*this);
     }
+    auto move(parser::MoveFunc* f) && -> This {
+        type_.moveFunc = f;
+        return std::move(*this);
+    }
     auto equal(parser::EqualFunc* f) && -> This {
         type_.equalFunc = f;
         return std::move(*this);
     }
+    auto hash(parser::HashFunc* f) && -> This {
+        type_.hashFunc = f;
+        return std::move(*this);
+    }
 #ifdef VALUE_DEBUG_DATA
     auto debugData(parser::DebugDataFunc* f) && -> This {
         type_.debugDataFunc = f;
         return std::move(*this);
     }
 #endif
+    auto traits(parser::TypeTraits traits) && -> This {
+        type_.traits = traits;
+        return std::move(*this);
+    }
     auto parser(parser::TypeParser parser) && -> This {
         type_.typeParser = parser;
         return std::move(*this);
@@ -77,9 +89,12 @@ auto typeModT(const char (&name)[N]) {
         .construct([](void* dest) { new (dest) T(); })
         .destruct([](void* dest) { std::launder(reinterpret_cast<T*>(dest))->~T(); })
         .clone([](void* dest, const void* source) { new (dest) T(*std::launder(reinterpret_cast<const T*>(source))); })
+        .move([](void* dest, void* source) { new (dest) T(std::move(*std::launder(reinterpret_cast<T*>(source)))); })
         .equal([](const void* a, const void* b) -> bool {
             return *std::launder(reinterpret_cast<const T*>(a)) == *std::launder(reinterpret_cast<const T*>(b));
         })
+        .hash(parser::hashFuncOf<T>())
+        .traits(parser::typeTraitsOf<T>())
 #ifdef VALUE_DEBUG_DATA
         .debugData([](std::ostream& out, const void* dest) -> std::ostream& {
             return out << *std::launder(reinterpret_cast<const T*>(dest));
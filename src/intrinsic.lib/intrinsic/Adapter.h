@@ -139,9 +139,14 @@ struct Adapter {
                 r.constructFunc = [](void* dest) { new (dest) T(); };
                 r.destructFunc = [](void* dest) { std::launder(reinterpret_cast<T*>(dest))->~T(); };
                 r.cloneFunc = [](void* dest, const void* source) { new (dest) T(*reinterpret_cast<const T*>(source)); };
+                r.moveFunc = [](void* dest, void* source) {
+                    new (dest) T(std::move(*std::launder(reinterpret_cast<T*>(source))));
+                };
+                r.traits = parser::typeTraitsOf<T>();
                 r.equalFunc = [](const void* a, const void* b) -> bool {
                     return *std::launder(reinterpret_cast<const T*>(a)) == *std::launder(reinterpret_cast<const T*>(b));
                 };
+                r.hashFunc = parser::hashFuncOf<T>();
                 return r;
             }());
 
@@ -197,9 +202,11 @@ struct Adapter {
         r.name = strings::to_string(info.name);
         r.flags = functionFlags(info.flags);
         r.parameters = instance::ParameterViews{parameter<ExternParams>(r.parameterScope)...};
+        r.updateParameterLayout();
 
         auto call = &details::Call<F, Params...>::call;
         r.body.block.nodes.emplace_back(parser::IntrinsicCall{call});
+        r.body.intrinsic = call; // note: arguments are stored at the offsets of the parameterSize partial sums
 
         auto indices = std::make_index_sequence<sizeof...(ExternParams)>{};
         trackParameters<ExternParams...>(r.parameters, indices);
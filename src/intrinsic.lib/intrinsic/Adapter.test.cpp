@@ -346,6 +346,7 @@ TEST(intrinsic, call) {
     ASSERT_TRUE(!add.body.block.nodes.empty());
     ASSERT_TRUE(add.body.block.nodes.front().holds<parser::IntrinsicCall>());
     auto& call = add.body.block.nodes.front().get<parser::IntrinsicCall>();
+    ASSERT_EQ(add.body.intrinsic, call.exec);
 
     constexpr auto u64_size = sizeof(uint64_t);
     constexpr auto ptr_size = sizeof(void*);
@@ -7,9 +7,11 @@
 
 #include "text/Range.h"
 
+#include "meta/Arena.h"
+#include "meta/ChunkedVector.h"
+#include "meta/Flags.h"
 #include "meta/Variant.h"
 
-#include <list>
 #include <vector>
 
 namespace intrinsic {
@@ -24,13 +26,18 @@ using OptView = strings::OptionalView;
 using Name = strings::String;
 using OptName = strings::OptionalString;
 
+// note: the tree containers allocate from the active meta::Arena, see meta::ArenaScope
+template<class T>
+using TreeAllocator = meta::ArenaAllocator<T>;
+
 struct Node;
-using Nodes = std::vector<Node>;
+using Nodes = std::vector<Node, TreeAllocator<Node>>;
 using NodePtr = std::unique_ptr<Node>;
 
 struct Block {
     using This = Block;
     Nodes nodes{};
+    uint32_t frameSize{}; // bytes of the variables initialised in this block, see FrameSlot
 
     bool operator==(const This& o) const { return nodes == o.nodes; }
     bool operator!=(const This& o) const { return !(*this == o); }
@@ -45,7 +52,7 @@ struct ArgumentAssignment {
     bool operator==(const This& o) const { return parameter == o.parameter && values == o.values; }
     bool operator!=(const This& o) const { return !(*this == o); }
 };
-using ArgumentAssignments = std::vector<ArgumentAssignment>;
+using ArgumentAssignments = std::vector<ArgumentAssignment, TreeAllocator<ArgumentAssignment>>;
 static_assert(meta::has_move_assignment<ArgumentAssignment>);
 
 struct Call {
@@ -68,9 +75,24 @@ struct IntrinsicCall {
 };
 static_assert(meta::has_move_assignment<IntrinsicCall>);
 
+/// location of a parameter or variable in the frames of the executed function
+///
+/// * every block has a frame for its variables, the arguments form the frame around the body block
+/// * depth counts the blocks from the referencing block up to the frame of the declaration
+/// note: resolved once the whole body is parsed, see execution::resolveSlots
+struct FrameSlot {
+    static constexpr uint32_t unresolved = ~0u;
+
+    uint32_t depth{};
+    uint32_t offset{unresolved}; // bytes from the start of the frame
+
+    bool resolved() const { return offset != unresolved; }
+};
+
 struct ParameterReference {
     using This = ParameterReference;
     instance::ParameterView parameter{};
+    FrameSlot slot{};
 
     bool operator==(const This& o) const { return parameter == o.parameter; }
     bool operator!=(const This& o) const { return !(*this == o); }
@@ -80,6 +102,7 @@ static_assert(meta::has_move_assignment<ParameterReference>);
 struct VariableReference {
     using This = VariableReference;
     instance::VariableView variable{};
+    FrameSlot slot{};
 
     bool operator==(const This& o) const { return variable == o.variable; }
     bool operator!=(const This& o) const { return !(*this == o); }
@@ -89,6 +112,7 @@ static_assert(meta::has_move_assignment<VariableReference>);
 struct VariableInit {
     using This = VariableInit;
     instance::VariableView variable{};
+    FrameSlot slot{};
     Nodes nodes{};
 
     bool operator==(const This& o) const { return variable == o.variable && nodes == o.nodes; }
@@ -107,7 +131,8 @@ static_assert(meta::has_move_assignment<ModuleReference>);
 
 struct NameTypeValue;
 using NameTypeValueView = const NameTypeValue*;
-using NameTypeValueList = std::list<NameTypeValue>;
+// note: references to entries have to stay valid
+using NameTypeValueList = meta::ChunkedVector<NameTypeValue, 4, TreeAllocator<NameTypeValue>>;
 
 struct NameTypeValueReference {
     using This = NameTypeValueReference;
@@ -146,9 +171,37 @@ using NodeVariant = meta::Variant<
     Value>;
 static_assert(meta::has_move_assignment<NodeVariant>);
 
+/// properties of a node including all its children
+enum class NodeProperty {
+    directlyExecutable = 1 << 0, // can be evaluated at compile time
+    sideEffects = 1 << 1, // evaluation triggers a compile time side effect
+};
+using NodeProperties = meta::Flags<NodeProperty>;
+META_FLAGS_OP(NodeProperties)
+
+namespace details {
+
+// note: templated to access instance::Function only on instantiation, where it is complete
+template<class Function = instance::Function>
+auto nodeProperties(const NodeVariant& variant) -> NodeProperties;
+
+} // namespace details
+
 // note: this type is needed because we cannot forward a using definition
 struct Node : public NodeVariant {
-    META_VARIANT_CONSTRUCT(Node, NodeVariant)
+    using This = Node;
+    NodeProperties properties{}; // note: computed bottom up on construction, updates of the alternative are not tracked
+
+    Node() = default;
+
+    template<
+        class... A,
+        typename = std::enable_if_t<(
+            sizeof...(A) != 1 ||
+            !meta::same_remove_const_ref_head_type<Node, A...>)&&std::is_constructible_v<NodeVariant, A...>>>
+    Node(A&&... a)
+        : NodeVariant(std::forward<A>(a)...)
+        , properties(details::nodeProperties(*this)) {}
 };
 using OptNode = meta::Optional<Node>;
 using NodeView = const Node*;
@@ -173,6 +226,58 @@ using OptNameTypeValueView = meta::Optional<meta::DefaultPacked<NameTypeValueVie
 
 static_assert(meta::has_move_assignment<NameTypeValue>);
 
+namespace details {
+
+// children that are not directly executable or have side effects propagate to the parent
+inline auto combineProperties(NodeProperties parent, NodeProperties child) -> NodeProperties {
+    if (!child[NodeProperty::directlyExecutable]) parent = parent.reset(NodeProperty::directlyExecutable);
+    if (child[NodeProperty::sideEffects]) parent = parent.set(NodeProperty::sideEffects);
+    return parent;
+}
+
+inline auto nodesProperties(const Nodes& nodes) -> NodeProperties {
+    auto result = NodeProperties{NodeProperty::directlyExecutable};
+    for (auto& node : nodes) result = combineProperties(result, node.properties);
+    return result;
+}
+
+inline auto typedProperties(const NameTypeValue& typed) -> NodeProperties {
+    auto result = typed.value ? typed.value.value().properties : NodeProperties{NodeProperty::directlyExecutable};
+    if (typed.type && typed.type.value() == nullptr) result = result.reset(NodeProperty::directlyExecutable);
+    return result;
+}
+
+template<class Function>
+auto nodeProperties(const NodeVariant& variant) -> NodeProperties {
+    using Flag = NodeProperty;
+    return variant.visit(
+        [](const Block& block) { return nodesProperties(block.nodes).reset(Flag::directlyExecutable); },
+        [](const Call& call) {
+            auto result = NodeProperties{Flag::directlyExecutable};
+            for (auto& arg : call.arguments) result = combineProperties(result, nodesProperties(arg.values));
+            const Function* function = call.function;
+            if (!function) return result.reset(Flag::directlyExecutable);
+            using FunctionFlag = typename decltype(function->flags)::Enum;
+            if (function->flags.none(FunctionFlag::compiletime)) result = result.reset(Flag::directlyExecutable);
+            if (function->flags.all(FunctionFlag::compiletime_sideeffects)) result = result.set(Flag::sideEffects);
+            return result;
+        },
+        [](const IntrinsicCall&) { return NodeProperties{}; },
+        [](const ParameterReference&) { return NodeProperties{}; },
+        [](const VariableReference&) { return NodeProperties{}; },
+        [](const NameTypeValueReference&) { return NodeProperties{Flag::directlyExecutable}; },
+        [](const VariableInit& init) { return nodesProperties(init.nodes).reset(Flag::directlyExecutable); },
+        [](const ModuleReference&) { return NodeProperties{}; },
+        [](const NameTypeValueTuple& tuple) {
+            auto result = NodeProperties{Flag::directlyExecutable};
+            for (auto& typed : tuple.tuple) result = combineProperties(result, typedProperties(typed));
+            return result;
+        },
+        [](const Value&) { return NodeProperties{Flag::directlyExecutable}; });
+}
+
+} // namespace details
+
 struct ViewNameTypeValue {
     using This = ViewNameTypeValue;
     OptView name{};
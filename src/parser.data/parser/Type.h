@@ -1,8 +1,13 @@
 #pragma once
 #include "instance/Views.h"
 
+#include "meta/Flags.h"
 #include "meta/Optional.h"
 
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
 #if !defined(VALUE_DEBUG_DATA)
 #    if defined(_DEBUG)
 #        define VALUE_DEBUG_DATA
@@ -20,11 +25,33 @@ using instance::ModuleView;
 using ConstructFunc = void(void* dest);
 using DestructFunc = void(void* dest);
 using CloneFunc = void(void* dest, const void* source);
+using MoveFunc = void(void* dest, void* source); // source stays constructed
 using EqualFunc = bool(const void*, const void*);
+using HashFunc = size_t(const void*); // hash has to be consistent with equal
 #ifdef VALUE_DEBUG_DATA
 using DebugDataFunc = auto(std::ostream& out, const void*) -> std::ostream&;
 #endif
 
+/// allows Value and the execution to bypass the functions of a type
+enum class TypeTrait {
+    triviallyCopyable = 1 << 0, // clone and move are a memcpy
+    triviallyDestructible = 1 << 1, // destruct does nothing
+    bitwiseComparable = 1 << 2, // equal is a memcmp
+};
+using TypeTraits = meta::Flags<TypeTrait>;
+META_FLAGS_OP(TypeTraits)
+
+template<class T>
+constexpr auto typeTraitsOf() -> TypeTraits {
+    auto result = TypeTraits{};
+    if constexpr (std::is_trivially_copyable_v<T>) result = result.set(TypeTrait::triviallyCopyable);
+    if constexpr (std::is_trivially_destructible_v<T>) result = result.set(TypeTrait::triviallyDestructible);
+    // note: class types may compare differently than their bits (e.g. views)
+    if constexpr (std::is_scalar_v<T> && std::has_unique_object_representations_v<T>)
+        result = result.set(TypeTrait::bitwiseComparable);
+    return result;
+}
+
 enum class TypeParser {
     Expression,
     SingleToken,
@@ -38,7 +65,10 @@ struct Type {
     ConstructFunc* constructFunc{};
     DestructFunc* destructFunc{};
     CloneFunc* cloneFunc{};
+    MoveFunc* moveFunc{}; // optional, cloneFunc is used otherwise
     EqualFunc* equalFunc{};
+    HashFunc* hashFunc{}; // optional, values without hash are not memoised
+    TypeTraits traits{};
     TypeParser typeParser{};
 #ifdef VALUE_DEBUG_DATA
     DebugDataFunc* debugDataFunc{};
@@ -47,4 +77,59 @@ struct Type {
 using TypeView = const Type*;
 using OptTypeView = meta::Optional<TypeView>;
 
+namespace details {
+
+// FNV-1a
+inline auto hashBytes(const void* data, size_t size) -> size_t {
+    auto hash = uint64_t{14695981039346656037u};
+    auto* bytes = static_cast<const unsigned char*>(data);
+    for (auto i = 0u; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211u;
+    return static_cast<size_t>(hash);
+}
+
+// note: fixed sizes allow the compiler to inline the copy
+inline void copyBytes(void* dest, const void* source, uint64_t size) {
+    switch (size) {
+    case 1: std::memcpy(dest, source, 1); return;
+    case 2: std::memcpy(dest, source, 2); return;
+    case 4: std::memcpy(dest, source, 4); return;
+    case 8: std::memcpy(dest, source, 8); return;
+    case 16: std::memcpy(dest, source, 16); return;
+    default: std::memcpy(dest, source, size);
+    }
+}
+
+} // namespace details
+
+/// copy constructs the value of type at dest
+inline void cloneValue(const Type& type, void* dest, const void* source) {
+    if (type.traits[TypeTrait::triviallyCopyable])
+        details::copyBytes(dest, source, type.size);
+    else
+        type.cloneFunc(dest, source);
+}
+
+inline void destructValue(const Type& type, void* dest) {
+    if (!type.traits[TypeTrait::triviallyDestructible]) type.destructFunc(dest);
+}
+
+inline bool equalValues(const Type& type, const void* a, const void* b) {
+    if (type.traits[TypeTrait::bitwiseComparable]) return 0 == std::memcmp(a, b, type.size);
+    return type.equalFunc(a, b);
+}
+
+/// hash for values of T, nullptr if T is neither bitwise comparable nor supported by std::hash
+template<class T>
+auto hashFuncOf() -> HashFunc* {
+    if constexpr (typeTraitsOf<T>()[TypeTrait::bitwiseComparable]) {
+        return [](const void* data) { return details::hashBytes(data, sizeof(T)); };
+    }
+    else if constexpr (std::is_default_constructible_v<std::hash<T>>) {
+        return [](const void* data) { return std::hash<T>{}(*std::launder(reinterpret_cast<const T*>(data))); };
+    }
+    else {
+        return nullptr;
+    }
+}
+
 } // namespace parser
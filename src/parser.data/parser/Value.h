@@ -3,61 +3,67 @@
 
 #include "meta/TypeTraits.h"
 
+#include <cstddef>
+#include <new>
+
 namespace parser {
 
+/// owns a value of any type
+///
+/// small values are stored inline, bigger or overaligned values on the heap
+/// note: a moved from value is empty
 struct Value {
     using This = Value;
+    static constexpr size_t inlineSize = 32;
+    static constexpr size_t inlineAlignment = alignof(std::max_align_t);
 
     Value() = default;
     explicit Value(TypeView type)
-        : m_type(type)
-        , m_storage(m_type ? new uint8_t[type->size] : nullptr) {
-        if (m_type) m_type->constructFunc(data());
-    }
-    ~Value() {
-        if (m_type && m_storage) m_type->destructFunc(data());
+        : m_type(type) {
+        if (!m_type) return;
+        allocate();
+        m_type->constructFunc(data());
     }
+    ~Value() { reset(); }
 
     Value(const This& o)
-        : m_type(o.m_type)
-        , m_storage(m_type ? new uint8_t[o.m_type->size] : nullptr) {
-        if (m_type) m_type->cloneFunc(data(), o.data());
+        : m_type(o.m_type) {
+        if (!m_type) return;
+        allocate();
+        cloneFrom(o.data());
     }
     auto operator=(const This& o) -> This& {
-        if (m_type != nullptr) {
-            if (m_storage) m_type->destructFunc(data());
-            if (o.m_type == nullptr) {
-                m_storage.reset(nullptr);
-                m_type = nullptr;
-            }
-            else {
-                if (m_type != o.m_type) {
-                    m_type = o.m_type;
-                    if (m_type->size != o.m_type->size) m_storage.reset(new uint8_t[o.m_type->size]);
-                }
-                m_type->cloneFunc(data(), o.data());
-            }
-        }
-        else if (m_type != nullptr) {
-            m_type = o.m_type;
-            m_storage.reset(new uint8_t[o.m_type->size]);
-            m_type->cloneFunc(data(), o.data());
+        if (this == &o) return *this;
+        reset();
+        m_type = o.m_type;
+        if (m_type) {
+            allocate();
+            cloneFrom(o.data());
         }
         return *this;
     }
 
-    Value(This&& o) = default;
-    auto operator=(This&& o) -> This& = default;
+    Value(This&& o) noexcept
+        : m_type(o.m_type) {
+        moveFrom(o);
+    }
+    auto operator=(This&& o) noexcept -> This& {
+        if (this == &o) return *this;
+        reset();
+        m_type = o.m_type;
+        moveFrom(o);
+        return *this;
+    }
 
     bool operator==(const This& o) const {
-        return m_type == o.m_type && (m_type == nullptr || m_type->equalFunc(data(), o.data()));
+        return m_type == o.m_type && (m_type == nullptr || equalValues(*m_type, data(), o.data()));
     }
     bool operator!=(const This& o) const { return !(*this == o); }
 
     auto type() const& -> TypeView { return m_type; }
 
-    auto data() const& -> const void* { return m_storage.get(); }
-    auto data() & -> void* { return m_storage.get(); }
+    auto data() const& -> const void* { return m_type ? (isInline(m_type) ? m_inline : m_heap) : nullptr; }
+    auto data() & -> void* { return m_type ? (isInline(m_type) ? m_inline : m_heap) : nullptr; }
 
     template<class T>
     auto get() const& -> const T& {
@@ -68,9 +74,56 @@ struct Value {
         return *std::launder(reinterpret_cast<T*>(data()));
     }
 
+    static bool isInline(TypeView type) {
+        return type->size <= inlineSize && type->alignment <= inlineAlignment;
+    }
+
+private:
+    static auto heapAlignment(TypeView type) -> std::align_val_t {
+        return std::align_val_t{type->alignment > inlineAlignment ? type->alignment : inlineAlignment};
+    }
+
+    // storage for m_type, the value is not constructed
+    void allocate() {
+        if (!isInline(m_type)) m_heap = ::operator new(m_type->size, heapAlignment(m_type));
+    }
+
+    void cloneFrom(const void* source) { cloneValue(*m_type, data(), source); }
+
+    // takes the value of o, which has the same type, o is left empty
+    void moveFrom(This& o) noexcept {
+        if (!m_type) return;
+        if (!isInline(m_type)) {
+            m_heap = o.m_heap;
+        }
+        else if (m_type->traits[TypeTrait::triviallyCopyable]) {
+            details::copyBytes(m_inline, o.m_inline, m_type->size);
+        }
+        else {
+            if (m_type->moveFunc)
+                m_type->moveFunc(m_inline, o.m_inline);
+            else
+                m_type->cloneFunc(m_inline, o.m_inline);
+            o.destruct();
+        }
+        o.m_type = nullptr;
+    }
+
+    void destruct() { destructValue(*m_type, data()); }
+
+    void reset() {
+        if (!m_type) return;
+        destruct();
+        if (!isInline(m_type)) ::operator delete(m_heap, heapAlignment(m_type));
+        m_type = nullptr;
+    }
+
 private:
     TypeView m_type{};
-    std::unique_ptr<uint8_t[]> m_storage{};
+    union {
+        alignas(inlineAlignment) std::byte m_inline[inlineSize];
+        void* m_heap;
+    };
 };
 static_assert(meta::has_move_assignment<Value>);
 
@@ -0,0 +1,86 @@
+#include "parser/Value.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+
+using namespace parser;
+
+namespace {
+
+template<class T>
+auto typeOf() -> Type {
+    auto r = Type{};
+    r.size = sizeof(T);
+    r.alignment = alignof(T);
+    r.constructFunc = [](void* dest) { new (dest) T(); };
+    r.destructFunc = [](void* dest) { std::launder(reinterpret_cast<T*>(dest))->~T(); };
+    r.cloneFunc = [](void* dest, const void* source) { new (dest) T(*reinterpret_cast<const T*>(source)); };
+    r.moveFunc = [](void* dest, void* source) { new (dest) T(std::move(*std::launder(reinterpret_cast<T*>(source)))); };
+    r.equalFunc = [](const void* a, const void* b) {
+        return *reinterpret_cast<const T*>(a) == *reinterpret_cast<const T*>(b);
+    };
+    r.traits = typeTraitsOf<T>();
+    return r;
+}
+
+struct Big {
+    std::array<uint64_t, 8> data{};
+    bool operator==(const Big& o) const { return data == o.data; }
+};
+
+} // namespace
+
+TEST(value, inlineTrivial) {
+    static const auto type = typeOf<uint64_t>();
+    ASSERT_TRUE(Value::isInline(&type));
+    ASSERT_TRUE(type.traits.all(
+        TypeTrait::triviallyCopyable, TypeTrait::triviallyDestructible, TypeTrait::bitwiseComparable));
+
+    auto value = Value{&type};
+    ASSERT_EQ(value.data(), static_cast<void*>(&value.set<uint64_t>()));
+    value.set<uint64_t>() = 42;
+
+    auto copy = value;
+    ASSERT_EQ(copy.get<uint64_t>(), 42u);
+    ASSERT_EQ(copy, value);
+
+    auto moved = Value{std::move(value)};
+    ASSERT_EQ(moved.get<uint64_t>(), 42u);
+    ASSERT_EQ(value.type(), nullptr);
+}
+
+TEST(value, inlineNonTrivial) {
+    static const auto type = typeOf<std::string>();
+    ASSERT_EQ(Value::isInline(&type), sizeof(std::string) <= Value::inlineSize);
+    ASSERT_TRUE(type.traits.none());
+
+    auto value = Value{&type};
+    value.set<std::string>() = std::string(100, 'x');
+
+    auto copy = value;
+    ASSERT_EQ(copy.get<std::string>(), std::string(100, 'x'));
+
+    auto moved = Value{};
+    moved = std::move(copy);
+    ASSERT_EQ(moved, value);
+    ASSERT_EQ(copy.type(), nullptr);
+}
+
+TEST(value, heapStorage) {
+    static const auto type = typeOf<Big>();
+    ASSERT_FALSE(Value::isInline(&type));
+
+    auto value = Value{&type};
+    value.set<Big>().data[7] = 7;
+    auto* storage = value.data();
+
+    auto copy = value;
+    ASSERT_NE(copy.data(), storage);
+    ASSERT_EQ(copy, value);
+
+    auto moved = Value{std::move(value)};
+    ASSERT_EQ(moved.data(), storage); // heap storage is taken over
+    ASSERT_EQ(moved.get<Big>().data[7], 7u);
+}
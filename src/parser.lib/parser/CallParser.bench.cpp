@@ -0,0 +1,105 @@
+#include "parser/CallParser.h"
+
+#include "parser/Tree.builder.h"
+
+#include "nesting/Token.builder.h"
+
+#include "instance/Scope.builder.h"
+#include "instance/Type.builder.h"
+
+#include "bench/Benchmark.h"
+
+#include <string>
+
+using namespace parser;
+
+namespace {
+
+struct BenchCallExternal {
+    Node value{};
+
+    template<class Type>
+    auto intrinsicType(meta::Type<Type>) -> instance::TypeView {
+        return {};
+    }
+    void reportDiagnostic(diagnostic::Diagnostic) {}
+
+    auto parserForType(const TypeView&) {
+        return [this](BlockLineView& blv) -> OptNode {
+            if (!blv) return {};
+            ++blv;
+            return value;
+        };
+    }
+
+    template<class Callback>
+    auto parseTypedWithCallback(BlockLineView& blv, Callback&& cb) -> OptNameTypeValue {
+        if (!blv) return {};
+        auto r = OptNameTypeValue{NameTypeValue{}}; // positional argument
+        cb(r.value());
+        return r;
+    }
+};
+
+auto makeName(const std::string& text) -> instance::Name { return {text.data(), text.data() + text.size()}; }
+
+/// overload "f" with parameterCount right parameters, all of type NumLit
+auto makeOverload(int parameterCount, TypeView type) -> instance::Function {
+    auto fun = instance::Function{};
+    fun.name = makeName("f");
+    fun.flags = instance::FunctionFlag::runtime;
+    for (auto p = 0; p < parameterCount; p++) {
+        auto param = instance::Parameter{};
+        param.typed.name = makeName("p" + std::to_string(p));
+        param.typed.type = type;
+        param.side = instance::ParameterSide::right;
+        auto entry = fun.parameterScope.emplace(std::move(param));
+        fun.parameters.push_back(&entry->get<instance::Parameter>());
+    }
+    fun.updateParameterLayout();
+    return fun;
+}
+
+constexpr auto maxParams = 8;
+
+/// resolve a call with 4 positional arguments against a growing overload set
+/// note: with an arena all nodes of the candidates are allocated from it, it is released after each parse
+void callParserOverloads(bench::State& state, meta::Arena* arena) {
+    auto scope = instance::Scope{};
+    instance::buildScope(scope, instance::typeModT<nesting::NumberLiteral>("NumLit"));
+    auto type = parser::type("NumLit").build(scope);
+
+    auto functions = std::vector<instance::Function>{};
+    functions.reserve(static_cast<size_t>(state.arg()));
+    for (auto i = 0; i < state.arg(); i++) functions.push_back(makeOverload(1 + i % maxParams, type));
+
+    auto input = BlockLine{{nesting::num("1"), nesting::num("2"), nesting::num("3"), nesting::num("4")}, {}};
+    auto ext = BenchCallExternal{};
+    ext.value = parser::expr(nesting::num("1")).typeName("NumLit").build(scope);
+
+    while (state.keepRunning()) {
+        {
+            auto arenaScope = meta::ArenaScope{arena};
+            auto os = CallOverloads{};
+            os.items.reserve(functions.size());
+            for (auto& f : functions) os.items.emplace_back(&f);
+            auto it = BlockLineView{&input};
+            CallParser::parse(os, it, ext);
+            bench::doNotOptimize(os);
+        }
+        if (arena) arena->release();
+    }
+    state.setItemsProcessed(state.iterations() * functions.size());
+    state.setCounter("peakRssKB", static_cast<double>(bench::peakResidentBytes() / 1024));
+}
+
+void callParserOverloadsHeap(bench::State& state) { callParserOverloads(state, nullptr); }
+BENCHMARK(callParserOverloadsHeap, 1, 8, 64, 512);
+
+void callParserOverloadsArena(bench::State& state) {
+    auto arena = meta::Arena{};
+    callParserOverloads(state, &arena);
+}
+BENCHMARK(callParserOverloadsArena, 1, 8, 64, 512);
+
+} // namespace
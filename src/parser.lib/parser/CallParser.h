@@ -5,6 +5,10 @@
 
 #include "instance/Function.h"
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 namespace parser {
 
 using instance::FunctionView;
@@ -31,6 +35,7 @@ struct CallOverloads {
     using Items = std::vector<Item>;
     Items items{};
     int sideEffects{}; // the total side effects that were created during parsing
+    int reusedParses{}; // argument parses that were shared between items
     bool tainted{}; // true if error was already reported
 
     auto countComplete() const -> int {
@@ -73,7 +78,6 @@ struct CallParser {
 private:
     using Item = CallOverloads::Item;
     using Items = CallOverloads::Items;
-    using ItemIt = Items::iterator;
 
     template<class T>
     static bool isTyped(const TypeView& t, External<T>& external) {
@@ -114,49 +118,131 @@ private:
         if (it && it.current().holds<nesting::CommaSeparator>()) ++it; // skip CommaSeparator
     }
 
+    /// active items ordered by their next parsing position, items on the same position keep their order
+    struct ItemQueue {
+        using Group = std::vector<Item*>;
+
+        explicit ItemQueue(Items& items)
+            : first(items.data()) {
+            heap.reserve(items.size());
+            for (auto& item : items)
+                if (item.active) push(item);
+        }
+
+        // extracts all items with the smallest parsing position
+        bool popGroup(Group& group) {
+            group.clear();
+            if (heap.empty()) return false;
+            auto position = heap.front().position;
+            while (!heap.empty() && heap.front().position == position) {
+                std::pop_heap(heap.begin(), heap.end(), Entry::later);
+                group.push_back(first + heap.back().order);
+                heap.pop_back();
+            }
+            return true;
+        }
+
+        void pushActive(const Group& group) {
+            for (auto* item : group)
+                if (item->active) push(*item);
+        }
+
+    private:
+        struct Entry {
+            size_t position;
+            size_t order;
+
+            static bool later(const Entry& l, const Entry& r) {
+                return l.position > r.position || (l.position == r.position && l.order > r.order);
+            }
+        };
+
+        void push(Item& item) {
+            heap.push_back({item.it.index(), static_cast<size_t>(&item - first)});
+            std::push_heap(heap.begin(), heap.end(), Entry::later);
+        }
+
+        Item* first;
+        std::vector<Entry> heap{};
+    };
+    using Group = ItemQueue::Group;
+    using GroupIt = Group::iterator;
+
+    /// argument values parsed at a position, shared by all items that expect the same kind of parser
+    ///
+    /// note: parserForType has to select the parser only based on the TypeParser of the type
+    struct ArgumentMemo {
+        struct Key {
+            size_t position;
+            TypeParser parser;
+
+            bool operator<(const Key& o) const {
+                return position < o.position || (position == o.position && parser < o.parser);
+            }
+        };
+        struct Result {
+            OptNode value;
+            BlockLineView end; // position after the value
+        };
+
+        static auto keyFor(const BlockLineView& it, const TypeView& type) -> Key {
+            return {it.index(), type ? type->typeParser : TypeParser::Expression};
+        }
+
+        auto find(const Key& key) const -> const Result* {
+            auto it = results.find(key);
+            return it != results.end() ? &it->second : nullptr;
+        }
+
+        // values with side effects are never shared, each item has to trigger them
+        void store(const Key& key, const OptNode& value, const BlockLineView& end) {
+            if (value && hasSideEffects(value.value())) return;
+            results.emplace(key, Result{value, end});
+        }
+
+    private:
+        std::map<Key, Result> results{};
+    };
+
     template<class T>
     static void parseArgumentsWithout(CallOverloads& os, BlockLineView& startIt, External<T>& external) {
         for (auto& o : os.items) o.it = startIt;
-        auto itemBegin = begin(os.items);
-        auto itemEnd = end(os.items);
-        auto active = itemEnd;
+        auto queue = ItemQueue{os.items};
+        auto memo = ArgumentMemo{};
+        auto group = Group{};
+        auto groupEnd = GroupIt{};
 
-        auto partitionActive = [&] {
-            active = std::stable_partition(itemBegin, active, [](auto& o) { return o.active; });
-        };
-        auto nextItem = [&] {
-            return std::min_element(itemBegin, active, [](auto& l, auto& r) { return l.it < r.it; });
-        };
-        auto skipItem = [&](ItemIt& itemIt, auto it) {
+        auto skipItem = [&](GroupIt& itemIt, auto it) {
             for (itemIt++;; itemIt++) {
-                if (itemIt == active) return false;
-                if (itemIt->it != it) continue;
+                if (itemIt == groupEnd) return false;
+                if ((*itemIt)->it != it) continue;
                 return true;
             }
         };
 
-        auto paramByName = [&](const ItemIt& itemIt, strings::View name) -> OptParameterView {
-            return itemIt->function->lookupParameter(name);
+        auto paramByName = [&](const GroupIt& itemIt, strings::View name) -> OptParameterView {
+            return (*itemIt)->function->lookupParameter(name);
         };
-        auto paramByPos = [&](const ItemIt& itemIt) -> OptParameterView {
-            auto params = itemIt->function->rightParameters(); // TODO(arBmind): cache rightParameters!
-            if (itemIt->argIndex < 0 || itemIt->argIndex >= params.size()) return {};
-            return params[itemIt->argIndex];
+        auto paramByPos = [&](const GroupIt& itemIt) -> OptParameterView {
+            auto params = (*itemIt)->function->rightParameters();
+            auto argIndex = (*itemIt)->argIndex;
+            if (argIndex < 0 || static_cast<size_t>(argIndex) >= params.size()) return {};
+            return params[argIndex];
         };
-        auto scanParamByName = [&](ItemIt& itemIt, strings::View name) -> OptParameterView {
+        auto scanParamByName = [&](GroupIt& itemIt, strings::View name) -> OptParameterView {
             while (true) {
                 auto optParam = paramByName(itemIt, name);
                 if (optParam) return optParam;
-                itemIt->active = false;
-                if (!skipItem(itemIt, itemIt->it)) return {};
+                (*itemIt)->active = false;
+                if (!skipItem(itemIt, (*itemIt)->it)) return {};
             }
         };
-        auto scanParamByPos = [&](ItemIt& itemIt) -> OptParameterView {
+        auto scanParamByPos = [&](GroupIt& itemIt) -> OptParameterView {
             while (true) {
                 auto optParam = paramByPos(itemIt);
                 if (optParam) return optParam;
-                itemIt->active = false;
-                if (!skipItem(itemIt, itemIt->it)) return {};
+                (*itemIt)->active = false;
+                if (!skipItem(itemIt, (*itemIt)->it)) return {};
             }
         };
         auto updateStatus = [](Item& item) {
@@ -166,29 +252,30 @@ private:
                 item.active = false;
             }
         };
-        auto assignParam = [&](ItemIt& itemIt, BlockLineView& it, const NameTypeValue& typed) {
+        auto assignParam = [&](GroupIt& itemIt, BlockLineView& it, const NameTypeValue& typed) {
             bool sideEffect = hasSideEffects(typed);
             if (sideEffect) os.sideEffects++;
             auto allowMismatch = bool{};
-            auto baseIt = itemIt->it;
+            auto baseIt = (*itemIt)->it;
             auto isNamed = typed.name && !typed.type;
             while (true) {
+                auto& item = **itemIt;
                 auto optParam = isNamed ? paramByName(itemIt, typed.name.value()) : paramByPos(itemIt);
                 if (optParam && canImplicitConvert(typed, optParam.value(), external)) {
                     auto param = optParam.value();
                     auto as = ArgumentAssignment{};
                     as.parameter = param;
                     as.values = implicitConvert(typed, param, external);
-                    itemIt->args.push_back(std::move(as));
-                    itemIt->it = it;
-                    itemIt->argIndex = isNamed && paramByPos(itemIt) != optParam ? -1 : (itemIt->argIndex + 1);
-                    if (sideEffect) itemIt->sideEffects++;
-                    if (isNodeBlockLiteral(typed.value, external)) itemIt->hasBlocks = true;
-                    updateStatus(*itemIt);
-                    if (itemIt->active) parseOptionalComma(itemIt->it);
+                    item.args.push_back(std::move(as));
+                    item.it = it;
+                    item.argIndex = isNamed && paramByPos(itemIt) != optParam ? -1 : (item.argIndex + 1);
+                    if (sideEffect) item.sideEffects++;
+                    if (isNodeBlockLiteral(typed.value, external)) item.hasBlocks = true;
+                    updateStatus(item);
+                    if (item.active) parseOptionalComma(item.it);
                 }
                 else if (!allowMismatch) {
-                    itemIt->active = false;
+                    item.active = false;
                 }
 
                 allowMismatch = true;
@@ -196,31 +283,46 @@ private:
             }
         };
 
-        while (true) {
-            partitionActive();
-            if (active == itemBegin) break; // no active items
-
-            auto next = nextItem();
-            auto nextIt = next->it;
+        while (queue.popGroup(group)) {
+            groupEnd = group.end();
+            auto next = group.begin();
+            auto nextIt = (*next)->it;
+            if (!nextIt) { // end of input, no item of the group can parse any further
+                for (auto* item : group) item->active = false;
+                continue;
+            }
 
             auto parseValue = [&](NameTypeValue& typed) {
                 auto optParam =
                     (typed.name && !typed.type) ? scanParamByName(next, typed.name.value()) : scanParamByPos(next);
                 if (optParam) {
-                    auto parseArg = external.parserForType(optParam.value()->typed.type);
+                    const auto& type = optParam.value()->typed.type;
+                    auto key = ArgumentMemo::keyFor(nextIt, type);
+                    if (auto* result = memo.find(key); result) {
+                        typed.value = result->value;
+                        nextIt = result->end;
+                        os.reusedParses++;
+                        return;
+                    }
+                    auto parseArg = external.parserForType(type);
                     typed.value = parseArg(nextIt);
+                    memo.store(key, typed.value, nextIt);
                 }
                 // invalid Param cannot be parsed
             };
             auto optTyped = external.parseTypedWithCallback(nextIt, parseValue);
-            if (next == active) continue; // no params matched
-            if (optTyped) {
-                assignParam(next, nextIt, optTyped.value());
-            }
-            else {
-                next->active = false;
+            if (next != groupEnd) { // some params matched
+                if (optTyped) {
+                    assignParam(next, nextIt, optTyped.value());
+                }
+                else {
+                    (*next)->active = false;
+                }
             }
+            queue.pushActive(group);
         }
+        auto itemBegin = begin(os.items);
+        auto itemEnd = end(os.items);
         startIt =
             std::max_element(itemBegin, itemEnd, [](auto& l, auto& r) { return l.it.index() < r.it.index(); })->it;
         std::stable_partition(itemBegin, itemEnd, [](auto& o) { return o.complete; });
@@ -103,6 +103,7 @@ struct CallParserData {
     FunctionViews functions{};
     // expected
     int os_complete{};
+    int os_reused{};
     std::string diagnostics{};
 
     CallParserData(const char* name)
@@ -124,6 +125,10 @@ struct CallParserData {
         valueNodes[std::move(key)] = std::move(expr).build(*scope);
         return std::move(*this);
     }
+    auto noValue(std::string key) && -> CallParserData {
+        valueNodes[std::move(key)] = {};
+        return std::move(*this);
+    }
     auto typed(size_t key, details::NameTypeValueBuilder typed) && -> CallParserData {
         indexTyped[key] = std::move(typed).build(*scope);
         return std::move(*this);
@@ -138,6 +143,10 @@ struct CallParserData {
         os_complete = count;
         return std::move(*this);
     }
+    auto reused(int count) && -> CallParserData {
+        os_reused = count;
+        return std::move(*this);
+    }
     auto diag(std::string& text) && -> CallParserData {
         diagnostics = text;
         return std::move(*this);
@@ -152,6 +161,7 @@ static auto operator<<(std::ostream& out, const CallParserData& cpd) -> std::ost
     out << "indexTyped: " << cpd.indexTyped << '\n';
     out << "expected:\n";
     out << "  complete: " << cpd.os_complete << '\n';
+    out << "  reused: " << cpd.os_reused << '\n';
     out << "  diagnostics: " << cpd.diagnostics << '\n';
     return out;
 }
@@ -177,6 +187,7 @@ TEST_P(CallParserP, parse) {
 
     EXPECT_FALSE(it.hasNext());
     EXPECT_EQ(data.os_complete, std::count_if(begin(os.items), end(os.items), [](auto& o) { return o.complete; }));
+    EXPECT_EQ(data.os_reused, os.reusedParses);
     EXPECT_EQ(data.diagnostics, ext.diagnostics);
 }
 
@@ -243,5 +254,17 @@ INSTANTIATE_TEST_CASE_P(
                 .typed(0, parser::typed())
                 .value("[0]:NumLit", parser::expr(nesting::num("1")).typeName("NumLit"))
                 .complete(1);
+        }(),
+        [] {
+            return CallParserData("ReuseFailedParse") //
+                .ctx( //
+                    instance::typeModT<nesting::NumberLiteral>("NumLit"),
+                    instance::fun("print").runtime().params(instance::param("v").right().type(type("NumLit"))),
+                    instance::fun("print").runtime().params(instance::param("w").right().type(type("NumLit"))))
+                .in(nesting::num("1"))
+                .load("print")
+                .typed(0, parser::typed())
+                .noValue("[0]:NumLit")
+                .reused(1);
         }()),
     [](const ::testing::TestParamInfo<CallParserData>& inf) { return inf.param.name; });
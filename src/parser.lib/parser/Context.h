@@ -46,7 +46,7 @@ struct ContextApi {
         std::is_same_v<std::invoke_result_t<decltype(Context::reportDiagnostic), diagnostic::Diagnostic>, void>,
         "no reportDiagnostic");
 
-    explicit ContextApi(Context context, TupleLookup tupleLookup = {})
+    explicit ContextApi(Context context, const TupleLookup* tupleLookup = {})
         : context(std::move(context))
         , tupleLookup(tupleLookup) {}
 
@@ -61,16 +61,22 @@ struct ContextApi {
         return context.reportDiagnostic(std::move(diagnostic));
     }
 
-    [[nodiscard]] auto lookupTuple(strings::View view) const -> OptNameTypeValueView { return tupleLookup[view]; }
+    [[nodiscard]] auto lookupTuple(strings::View view) const -> OptNameTypeValueView {
+        if (!tupleLookup) return {};
+        return (*tupleLookup)[view];
+    }
 
-    auto withTupleLookup(const NameTypeValueTuple* tuple) {
-        auto subTupleLookup = TupleLookup{&tupleLookup, {tuple}};
-        return ContextApi(std::ref(context), subTupleLookup);
+    // note: the lookup has to outlive the returned api, it is shared so its name index is only built once
+    [[nodiscard]] auto tupleLookupFor(const NameTypeValueTuple* tuple) const -> TupleLookup {
+        return TupleLookup{tupleLookup, {tuple}};
+    }
+    auto withTupleLookup(const TupleLookup& subTupleLookup) {
+        return ContextApi(std::ref(context), &subTupleLookup);
     }
 
 private:
     Context context;
-    TupleLookup tupleLookup{};
+    const TupleLookup* tupleLookup{};
 };
 
 } // namespace parser
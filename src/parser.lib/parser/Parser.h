@@ -55,7 +55,8 @@ private:
     template<class Context>
     static auto parseTuple(BlockLineView& it, ContextApi<Context>& context) -> NameTypeValueTuple {
         auto tuple = NameTypeValueTuple{};
-        auto subContext = context.withTupleLookup(&tuple);
+        auto tupleLookup = context.tupleLookupFor(&tuple);
+        auto subContext = context.withTupleLookup(tupleLookup);
         if (!it) return tuple;
         auto withBrackets = it.current().holds<nesting::BracketOpen>();
         if (withBrackets) ++it;
@@ -379,7 +380,7 @@ private:
         CallParser::parse(co, it, Wrap<Context>{&context});
         if (co.countComplete() == 1) {
             auto& ci = co.items.front();
-            left = buildCallNode(Call{ci.function, ci.args}, context);
+            left = buildCallNode(Call{ci.function, std::move(ci.args)}, context);
             return ci.hasBlocks ? ParseOptions::finish_single : ParseOptions::continue_single;
         }
 
@@ -391,7 +392,7 @@ private:
     template<class Context>
     static auto buildCallNode(Call&& call, ContextApi<Context>& context) -> OptNode {
         if (isDirectlyExecutable(call)) {
-            return context.runCall(call);
+            return context.runCall(std::move(call));
         }
         return Node{std::move(call)};
     }
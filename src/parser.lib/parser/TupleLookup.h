@@ -1,22 +1,45 @@
 #pragma once
 #include "parser/Tree.h"
 
+#include <unordered_map>
+
 namespace parser {
 
 struct LocalTupleLookup {
+    using NameIndex = std::unordered_map<strings::CompareView, NameTypeValueView>;
+    static constexpr auto indexThreshold = size_t{8}; // smaller tuples are scanned
+
     const NameTypeValueTuple* tuple{};
+    mutable NameIndex index{}; // only used for wide tuples
+    mutable size_t indexed{}; // number of tuple entries in the index
 
     auto operator[](View name) const& -> OptNameTypeValueView {
-        if (tuple)
+        if (!tuple) return {};
+        if (tuple->tuple.size() <= indexThreshold) {
             for (auto& ntv : tuple->tuple) {
                 if (ntv.name && name.isContentEqual(ntv.name.value())) return &ntv;
             }
+            return {};
+        }
+        updateIndex();
+        if (auto it = index.find(name); it != index.end()) return it->second;
         return {};
     }
+
+    // note: the tuple grows while it is parsed, we only add the new entries
+    void updateIndex() const {
+        const auto& list = tuple->tuple;
+        for (; indexed < list.size(); indexed++) {
+            const auto& ntv = list[indexed];
+            if (ntv.name) index.emplace(View{ntv.name.value()}, &ntv); // first entry wins
+        }
+    }
 };
 
+/// chain of the tuples that are currently parsed
+/// note: lives next to its tuple and is referenced by the ContextApi, copies would rebuild the name index
 struct TupleLookup {
-    TupleLookup* parent{};
+    const TupleLookup* parent{};
     LocalTupleLookup tuple{};
 
     auto operator[](View name) const& -> OptNameTypeValueView {
@@ -0,0 +1,64 @@
+#include "parser/TupleLookup.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+using namespace parser;
+
+namespace {
+
+auto named(const std::string& name) -> NameTypeValue {
+    auto ntv = NameTypeValue{};
+    ntv.name = strings::String{name.data(), name.data() + name.size()};
+    return ntv;
+}
+
+auto lookup(const LocalTupleLookup& lookup, const std::string& name) -> OptNameTypeValueView {
+    return lookup[View{name.data(), name.data() + name.size()}];
+}
+
+} // namespace
+
+TEST(tupleLookup, wideTupleIndex) {
+    auto tuple = NameTypeValueTuple{};
+    for (auto i = 0; i < 12; i++) tuple.tuple.push_back(named("f" + std::to_string(i)));
+    tuple.tuple.push_back(NameTypeValue{}); // unnamed entries are skipped
+    auto lookupTuple = LocalTupleLookup{&tuple};
+
+    ASSERT_GT(tuple.tuple.size(), LocalTupleLookup::indexThreshold);
+    EXPECT_EQ(lookup(lookupTuple, "f0").value(), &tuple.tuple[0]);
+    EXPECT_EQ(lookup(lookupTuple, "f11").value(), &tuple.tuple[11]);
+    EXPECT_FALSE(lookup(lookupTuple, "f12"));
+    EXPECT_EQ(lookupTuple.indexed, tuple.tuple.size());
+
+    // the tuple grows while it is parsed
+    tuple.tuple.push_back(named("f12"));
+    EXPECT_EQ(lookup(lookupTuple, "f12").value(), &tuple.tuple[13]);
+    EXPECT_EQ(lookupTuple.indexed, tuple.tuple.size());
+}
+
+TEST(tupleLookup, firstDuplicateWins) {
+    auto tuple = NameTypeValueTuple{};
+    for (auto i = 0; i < 4; i++) tuple.tuple.push_back(named("dup"));
+    for (auto i = 0; i < 8; i++) tuple.tuple.push_back(named("f" + std::to_string(i)));
+    auto lookupTuple = LocalTupleLookup{&tuple};
+    EXPECT_EQ(lookup(lookupTuple, "dup").value(), &tuple.tuple[0]);
+
+    tuple.tuple.push_back(named("f0")); // added after the index was built
+    EXPECT_EQ(lookup(lookupTuple, "f0").value(), &tuple.tuple[4]);
+}
+
+TEST(tupleLookup, nestedLookupSharesParentIndex) {
+    auto outer = NameTypeValueTuple{};
+    for (auto i = 0; i < 12; i++) outer.tuple.push_back(named("f" + std::to_string(i)));
+    auto inner = NameTypeValueTuple{};
+    inner.tuple.push_back(named("g"));
+
+    auto outerLookup = TupleLookup{nullptr, LocalTupleLookup{&outer}};
+    auto innerLookup = TupleLookup{&outerLookup, LocalTupleLookup{&inner}};
+    auto name = std::string{"f3"};
+    auto found = innerLookup[View{name.data(), name.data() + name.size()}];
+    EXPECT_EQ(found.value(), &outer.tuple[3]);
+    EXPECT_EQ(outerLookup.tuple.indexed, outer.tuple.size()); // the index was built in place
+}
@@ -45,7 +45,8 @@ constexpr bool any(const C& c, F&& f) {
 }
 constexpr auto has_side_effects_call = [](auto& e) -> bool { return hasSideEffects(e); };
 
-inline bool hasSideEffects(const Node& node) { return node.visit(has_side_effects_call); }
+// note: the properties of a node are computed on construction
+inline bool hasSideEffects(const Node& node) { return node.properties[NodeProperty::sideEffects]; }
 inline bool hasSideEffects(const Nodes& nodes) { return any(nodes, has_side_effects_call); }
 
 inline bool hasSideEffects(const ArgumentAssignments& aas) { return any(aas, has_side_effects_call); }
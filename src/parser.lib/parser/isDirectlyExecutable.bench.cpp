@@ -0,0 +1,37 @@
+#include "parser/hasSideEffects.h"
+#include "parser/isDirectlyExecutable.h"
+
+#include "bench/Benchmark.h"
+
+using namespace parser;
+
+namespace {
+
+/// builds calls nested arg() levels deep, querying each level like Parser::buildCallNode does
+void nestedCallProperties(bench::State& state) {
+    auto param = instance::Parameter{};
+    param.side = instance::ParameterSide::right;
+    auto fun = instance::Function{};
+    fun.flags = instance::FunctionFlag::compiletime;
+    fun.parameters.push_back(&param);
+    fun.updateParameterLayout();
+
+    auto executable = int{};
+    while (state.keepRunning()) {
+        auto node = Node{Value{}};
+        for (auto depth = 0; depth < state.arg(); depth++) {
+            auto arg = ArgumentAssignment{&param, {}};
+            arg.values.push_back(std::move(node)); // note: an initializer list would copy the tree
+            auto call = Call{&fun, {}};
+            call.arguments.push_back(std::move(arg));
+            if (isDirectlyExecutable(call) && !hasSideEffects(call)) executable++;
+            node = Node{std::move(call)};
+        }
+        bench::doNotOptimize(node);
+    }
+    bench::doNotOptimize(executable);
+    state.setItemsProcessed(state.iterations() * state.arg());
+}
+BENCHMARK(nestedCallProperties, 16, 256, 4096);
+
+} // namespace
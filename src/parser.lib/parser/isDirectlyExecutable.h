@@ -19,23 +19,8 @@ inline bool isDirectlyExecutable(const NameTypeValue& typed) {
     return true;
 }
 
-inline bool isDirectlyExecutable(const Node& node) {
-    return node.visit(
-        [](const Block&) { return false; },
-        [](const Call& call) { return isDirectlyExecutable(call); },
-        [](const IntrinsicCall&) { return false; },
-        [](const ParameterReference&) { return false; },
-        [](const VariableReference&) { return false; },
-        [](const NameTypeValueReference&) { return true; },
-        [](const VariableInit&) { return false; },
-        [](const ModuleReference&) { return false; },
-        [](const NameTypeValueTuple& tuple) {
-            for (auto& typed : tuple.tuple)
-                if (!isDirectlyExecutable(typed)) return false;
-            return true;
-        },
-        [](const Value&) { return true; });
-}
+// note: the properties of a node are computed on construction
+inline bool isDirectlyExecutable(const Node& node) { return node.properties[NodeProperty::directlyExecutable]; }
 
 inline bool isDirectlyExecutable(const Call& call) {
     if (call.function->flags.none(instance::FunctionFlag::compiletime)) return false;
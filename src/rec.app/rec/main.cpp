@@ -1,12 +1,25 @@
 #include "rec/Compiler.h"
 
+#include <fstream>
 #include <iostream>
+#include <iterator>
 
 #ifdef _WIN32
 #    include <Windows.h>
 #endif
 
-int main() {
+namespace {
+
+auto readFile(const char* path) -> text::File {
+    auto in = std::ifstream{path, std::ios::binary};
+    auto content = std::vector<char>{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    auto name = std::string{path};
+    return text::File{strings::String{name.data(), name.data() + name.size()}, strings::String{std::move(content)}};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
 
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
@@ -18,9 +31,17 @@ int main() {
     // config.tokenOutput = &std::cout;
     // config.blockOutput = &std::cout;
     config.diagnosticsOutput = &std::cout;
+    // config.profileOutput = &std::cout;
 
     auto compiler = Compiler{config};
 
+    if (argc > 1) {
+        auto files = TextFiles{};
+        for (auto i = 1; i < argc; i++) files.push_back(readFile(argv[i]));
+        compiler.compileAll(files);
+        return 0;
+    }
+
     auto file = text::File{
         strings::String{"TestFile"},
         strings::String{""
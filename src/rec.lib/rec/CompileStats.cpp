@@ -0,0 +1,183 @@
+#include "CompileStats.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#if defined(_WIN32)
+#    include <malloc.h>
+#elif defined(__APPLE__)
+#    include <malloc/malloc.h>
+#else
+#    include <malloc.h>
+#endif
+
+namespace rec {
+
+namespace {
+
+thread_local AllocationTracker* t_allocationTracker{};
+
+// note: frees have no size, both sides count the usable size of the block
+auto usableSize(void* p) -> size_t {
+#if defined(_WIN32)
+    return _msize(p);
+#elif defined(__APPLE__)
+    return malloc_size(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+auto allocate(size_t size) noexcept -> void* {
+    auto* p = std::malloc(size != 0 ? size : 1);
+    if (p && t_allocationTracker) t_allocationTracker->allocated(usableSize(p));
+    return p;
+}
+
+void deallocate(void* p) noexcept {
+    if (!p) return;
+    if (t_allocationTracker) t_allocationTracker->freed(usableSize(p));
+    std::free(p);
+}
+
+void countAllocation(AllocationStats& stats, size_t bytes) {
+    stats.count++;
+    stats.bytes += bytes;
+    stats.live += static_cast<int64_t>(bytes);
+    if (stats.live > stats.peakLive) stats.peakLive = stats.live;
+}
+
+auto microseconds(CompileStats::Duration duration) -> int64_t {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+template<class F>
+void forEachStage(F&& f) {
+    for (auto i = size_t{}; i < stageCount; i++) f(static_cast<Stage>(i));
+}
+
+template<class F>
+void forEachCounter(const CompileStats& stats, F&& f) {
+    f("bytes", stats.bytes);
+    f("codePoints", stats.codePoints);
+    f("tokens", stats.tokens);
+    f("lines", stats.lines);
+    f("blocks", stats.blocks);
+    f("nodes", stats.nodes);
+    f("calls", stats.calls);
+    f("lookups", stats.lookups);
+}
+
+template<class F>
+void forEachAllocations(const CompileStats& stats, F&& f) {
+    forEachStage([&](Stage stage) { f(stageName(stage), stats.allocations[static_cast<size_t>(stage)]); });
+    f("other", stats.otherAllocations);
+    f("total", stats.totalAllocations);
+}
+
+} // namespace
+
+AllocationTracker::AllocationTracker(CompileStats& stats)
+    : stats(&stats)
+    , current(&stats.otherAllocations)
+    , previous(t_allocationTracker) {
+    stats.allocationsTracked = true;
+    t_allocationTracker = this;
+}
+
+AllocationTracker::~AllocationTracker() { t_allocationTracker = previous; }
+
+void AllocationTracker::allocated(size_t bytes) {
+    countAllocation(*current, bytes);
+    countAllocation(stats->totalAllocations, bytes);
+}
+
+void AllocationTracker::freed(size_t bytes) {
+    current->live -= static_cast<int64_t>(bytes);
+    stats->totalAllocations.live -= static_cast<int64_t>(bytes);
+}
+
+auto stageName(Stage stage) -> const char* {
+    switch (stage) {
+    case Stage::decode: return "decode";
+    case Stage::positions: return "positions";
+    case Stage::tokenize: return "tokenize";
+    case Stage::filter: return "filter";
+    case Stage::nest: return "nest";
+    case Stage::parse: return "parse";
+    case Stage::execute: return "execute";
+    case Stage::diagnostics: return "diagnostics";
+    }
+    return "";
+}
+
+auto CompileStats::total() const -> Duration {
+    auto sum = Duration{};
+    for (auto duration : elapsed) sum += duration;
+    return sum;
+}
+
+void writeTable(std::ostream& out, const CompileStats& stats) {
+    out << "\nCompile stats:\n";
+    forEachStage([&](Stage stage) {
+        out << std::setw(12) << stageName(stage) << std::setw(12) << microseconds(stats[stage]) << " us\n";
+    });
+    out << std::setw(12) << "total" << std::setw(12) << microseconds(stats.total()) << " us\n";
+    forEachCounter(stats, [&](const char* name, uint64_t value) {
+        out << std::setw(12) << name << std::setw(12) << value << '\n';
+    });
+    if (!stats.allocationsTracked) return;
+    out << "\nAllocations:\n";
+    out << std::setw(12) << "stage" << std::setw(12) << "count" << std::setw(14) << "bytes" << std::setw(14)
+        << "peak live" << '\n';
+    forEachAllocations(stats, [&](const char* name, const AllocationStats& allocations) {
+        out << std::setw(12) << name << std::setw(12) << allocations.count << std::setw(14) << allocations.bytes
+            << std::setw(14) << allocations.peakLive << '\n';
+    });
+}
+
+void writeJson(std::ostream& out, const CompileStats& stats) {
+    out << "{\"stages\":{";
+    auto separator = "";
+    forEachStage([&](Stage stage) {
+        out << separator << '"' << stageName(stage) << "\":" << microseconds(stats[stage]);
+        separator = ",";
+    });
+    out << "},\"unit\":\"us\"";
+    forEachCounter(stats, [&](const char* name, uint64_t value) { out << ",\"" << name << "\":" << value; });
+    if (stats.allocationsTracked) {
+        out << ",\"allocations\":{";
+        separator = "";
+        forEachAllocations(stats, [&](const char* name, const AllocationStats& allocations) {
+            out << separator << '"' << name << "\":{\"count\":" << allocations.count << ",\"bytes\":" << allocations.bytes
+                << ",\"peakLive\":" << allocations.peakLive << '}';
+            separator = ",";
+        });
+        out << '}';
+    }
+    out << "}\n";
+}
+
+} // namespace rec
+
+// counting global allocator, see AllocationTracker
+// note: the aligned variants keep their default implementation
+
+auto operator new(size_t size) -> void* {
+    if (auto* p = rec::allocate(size); p) return p;
+    throw std::bad_alloc{};
+}
+auto operator new[](size_t size) -> void* {
+    if (auto* p = rec::allocate(size); p) return p;
+    throw std::bad_alloc{};
+}
+auto operator new(size_t size, const std::nothrow_t&) noexcept -> void* { return rec::allocate(size); }
+auto operator new[](size_t size, const std::nothrow_t&) noexcept -> void* { return rec::allocate(size); }
+
+void operator delete(void* p) noexcept { rec::deallocate(p); }
+void operator delete[](void* p) noexcept { rec::deallocate(p); }
+void operator delete(void* p, size_t) noexcept { rec::deallocate(p); }
+void operator delete[](void* p, size_t) noexcept { rec::deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { rec::deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { rec::deallocate(p); }
@@ -0,0 +1,139 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace rec {
+
+/// stages of the compile pipeline
+enum class Stage : uint8_t {
+    decode, // strings::utf8Decode
+    positions, // text::decodePosition
+    tokenize, // scanner::tokenize
+    filter, // filter::filterTokens
+    nest, // nesting::nestTokens
+    parse, // parser::Parser::parse, includes blocks parsed by compile time calls
+    execute, // compile time execution
+    diagnostics, // collecting and writing diagnostics
+};
+constexpr auto stageCount = size_t{8};
+
+/// name of the stage as used in the outputs
+auto stageName(Stage stage) -> const char*;
+
+/// allocations of the compiling thread
+struct AllocationStats {
+    uint64_t count{};
+    uint64_t bytes{}; // usable size of all allocations
+    int64_t live{}; // allocated minus freed bytes, memory allocated before might be freed
+    int64_t peakLive{};
+};
+
+/// measurements of the last compile
+struct CompileStats {
+    using Duration = std::chrono::steady_clock::duration;
+
+    std::array<Duration, stageCount> elapsed{}; // exclusive time of each stage
+    uint64_t bytes{}; // utf8 input
+    uint64_t codePoints{}; // decoded code points, including invalid encodings
+    uint64_t tokens{}; // scanner tokens
+    uint64_t lines{}; // filtered token lines
+    uint64_t blocks{}; // block literals, including the top level
+    uint64_t nodes{}; // nodes of the top level block
+    uint64_t calls{}; // compile time calls and intrinsics
+    uint64_t lookups{}; // names looked up by the parser
+
+    bool allocationsTracked{};
+    std::array<AllocationStats, stageCount> allocations{}; // attributed to the running stage
+    AllocationStats otherAllocations{}; // outside of all stages
+    AllocationStats totalAllocations{};
+
+    auto operator[](Stage stage) const -> Duration { return elapsed[static_cast<size_t>(stage)]; }
+    auto total() const -> Duration;
+};
+
+/// writes a human readable table
+void writeTable(std::ostream& out, const CompileStats& stats);
+
+/// writes a single JSON object
+void writeJson(std::ostream& out, const CompileStats& stats);
+
+/// counts the allocations of the current thread while it exists
+///
+/// * replaces the global operator new and delete, they only count while a tracker is installed
+/// * aligned allocations and other threads are not counted
+struct AllocationTracker {
+    using This = AllocationTracker;
+
+    explicit AllocationTracker(CompileStats& stats);
+    ~AllocationTracker();
+
+    AllocationTracker(const This&) = delete;
+    auto operator=(const This&) -> This& = delete;
+
+    /// attributes the following allocations to the stage
+    void enter(const Stage* stage) {
+        current = stage ? &stats->allocations[static_cast<size_t>(*stage)] : &stats->otherAllocations;
+    }
+
+    void allocated(size_t bytes);
+    void freed(size_t bytes);
+
+private:
+    CompileStats* stats{};
+    AllocationStats* current{};
+    AllocationTracker* previous{}; // note: trackers nest
+};
+
+/// measures the exclusive time of nested stages
+///
+/// * entering a stage pauses the running stage until the entered one is left
+/// * lazy stages enter and leave for every produced value
+struct StageClock {
+    using Clock = std::chrono::steady_clock;
+
+    explicit StageClock(CompileStats& stats, AllocationTracker* allocations = {})
+        : stats(&stats)
+        , allocations(allocations) {}
+
+    void enter(Stage stage) {
+        auto now = Clock::now();
+        if (!active.empty()) stats->elapsed[static_cast<size_t>(active.back())] += now - since;
+        active.push_back(stage);
+        since = now;
+        if (allocations) allocations->enter(&active.back());
+    }
+    void leave() {
+        auto now = Clock::now();
+        stats->elapsed[static_cast<size_t>(active.back())] += now - since;
+        active.pop_back();
+        since = now;
+        if (allocations) allocations->enter(active.empty() ? nullptr : &active.back());
+    }
+
+private:
+    CompileStats* stats{};
+    AllocationTracker* allocations{};
+    std::vector<Stage> active{};
+    Clock::time_point since{};
+};
+
+/// runs a stage while it is in scope, does nothing without a clock
+struct StageScope {
+    StageClock* clock{};
+
+    StageScope(StageClock* clock, Stage stage)
+        : clock(clock) {
+        if (clock) clock->enter(stage);
+    }
+    ~StageScope() {
+        if (clock) clock->leave();
+    }
+
+    StageScope(const StageScope&) = delete;
+    auto operator=(const StageScope&) -> StageScope& = delete;
+};
+
+} // namespace rec
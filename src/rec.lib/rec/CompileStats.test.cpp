@@ -0,0 +1,71 @@
+#include "CompileStats.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace rec;
+
+TEST(CompileStats, nestedStagesAreExclusive) {
+    auto stats = CompileStats{};
+    auto clock = StageClock{stats};
+    {
+        auto parse = StageScope{&clock, Stage::parse};
+        auto execute = StageScope{&clock, Stage::execute};
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_GE(stats[Stage::execute], std::chrono::milliseconds(5));
+    EXPECT_LT(stats[Stage::parse], stats[Stage::execute]);
+    EXPECT_EQ(stats.total(), stats[Stage::parse] + stats[Stage::execute]);
+    EXPECT_EQ(stats[Stage::decode], CompileStats::Duration{});
+}
+
+TEST(CompileStats, json) {
+    auto stats = CompileStats{};
+    stats.elapsed[static_cast<size_t>(Stage::tokenize)] = std::chrono::microseconds(42);
+    stats.tokens = 7;
+    stats.lookups = 3;
+
+    auto out = std::stringstream{};
+    writeJson(out, stats);
+    EXPECT_EQ(
+        out.str(),
+        "{\"stages\":{\"decode\":0,\"positions\":0,\"tokenize\":42,\"filter\":0,\"nest\":0,\"parse\":0,\"execute\":0,"
+        "\"diagnostics\":0},"
+        "\"unit\":\"us\",\"bytes\":0,\"codePoints\":0,\"tokens\":7,\"lines\":0,\"blocks\":0,\"nodes\":0,\"calls\":0,"
+        "\"lookups\":3}\n");
+}
+
+TEST(CompileStats, allocationsOfStages) {
+    auto stats = CompileStats{};
+    {
+        auto tracker = AllocationTracker{stats};
+        auto clock = StageClock{stats, &tracker};
+        auto kept = std::unique_ptr<char[]>{};
+        {
+            auto parse = StageScope{&clock, Stage::parse};
+            auto values = std::vector<uint64_t>(1000);
+            kept = std::make_unique<char[]>(100);
+        }
+        {
+            auto execute = StageScope{&clock, Stage::execute};
+            kept.reset();
+        }
+    }
+    ASSERT_TRUE(stats.allocationsTracked);
+    const auto& parse = stats.allocations[static_cast<size_t>(Stage::parse)];
+    EXPECT_GE(parse.count, 2u);
+    EXPECT_GE(parse.bytes, 8100u);
+    EXPECT_GE(parse.peakLive, 8100);
+    EXPECT_GE(parse.live, 100);
+    EXPECT_LE(stats.allocations[static_cast<size_t>(Stage::execute)].live, -100);
+    EXPECT_GE(stats.totalAllocations.count, parse.count);
+    EXPECT_EQ(stats.allocations[static_cast<size_t>(Stage::decode)].count, 0u);
+
+    auto out = std::stringstream{};
+    writeJson(out, stats);
+    EXPECT_NE(out.str().find("\"allocations\":{\"decode\":{\"count\":0,"), std::string::npos);
+}
@@ -0,0 +1,47 @@
+#include "rec/Compiler.h"
+#include "rec/SourceGenerator.h"
+
+#include "bench/Benchmark.h"
+
+#include <string>
+
+namespace {
+
+auto toString(const std::string& text) -> strings::String { return {text.data(), text.data() + text.size()}; }
+
+/// full compilation of a synthetic file, reports peak memory of the process
+void compileDeclarations(bench::State& state) {
+    auto file = text::File{strings::String{"Bench"}, toString(rec::generate::declarations(state.arg()))};
+
+    while (state.keepRunning()) {
+        auto compiler = rec::Compiler{rec::Config{text::Column{8}}};
+        compiler.compile(file);
+    }
+    state.setBytesProcessed(state.iterations() * file.content.byteCount().v);
+    state.setCounter("peakRssKB", static_cast<double>(bench::peakResidentBytes() / 1024));
+}
+BENCHMARK(compileDeclarations, 100, 1000, 10000);
+
+/// compileAll of 200 files with the given number of front end workers
+/// note: parsing and execution stay serial, only the share of the pure stages scales
+void compileFiles(bench::State& state) {
+    auto files = rec::TextFiles{};
+    auto bytes = uint64_t{};
+    for (auto i = 0; i < 200; i++) {
+        auto name = "File" + std::to_string(i);
+        files.push_back(text::File{toString(name), toString(rec::generate::unit(i, 50))});
+        bytes += files.back().content.byteCount().v;
+    }
+
+    while (state.keepRunning()) {
+        auto config = rec::Config{text::Column{8}};
+        config.frontEndWorkers = static_cast<unsigned>(state.arg());
+        auto compiler = rec::Compiler{config};
+        compiler.compileAll(files);
+    }
+    state.setBytesProcessed(state.iterations() * bytes);
+    state.setItemsProcessed(state.iterations() * files.size());
+}
+BENCHMARK(compileFiles, 1, 8);
+
+} // namespace
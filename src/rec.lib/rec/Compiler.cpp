@@ -7,14 +7,22 @@
 #include "strings/utf8Decode.h"
 
 #include "api/Context.h"
+#include "execution/VM.h"
 #include "intrinsic/Adapter.h"
 #include "intrinsic/ResolveType.h"
 
+#include "meta/CoTap.h"
+
 #include "diagnostic/Diagnostic.ostream.h"
 #include "nesting/Token.ostream.h"
 #include "scanner/Token.ostream.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <optional>
+#include <sstream>
+#include <thread>
 
 namespace rec {
 
@@ -91,11 +99,195 @@ auto extractResults(Call& call, const InstanceScope& globals) -> OptNode {
     return {};
 }
 
+/// state of a thread that parses deferred bodies in parallel
+struct BodyWorker {
+    CompilerCallback* callback{}; // own stack for the calls of the worker
+    Diagnostics* diagnostics{};
+    bool* serial{}; // set if the body has to be parsed on the main thread
+};
+thread_local BodyWorker* t_bodyWorker{};
+
+// note: user functions might have side effects in their body, only intrinsics are known to be pure
+bool runsOnWorker(const instance::Function& function) {
+    return !function.flags.any(instance::FunctionFlag::compiletime_sideeffects) && function.body.intrinsic;
+}
+
+// counts and measures the values of a lazy stage
+template<class V>
+auto measured(meta::CoEnumerator<V> input, StageClock& clock, Stage stage, uint64_t& count) -> meta::CoEnumerator<V> {
+    while (true) {
+        clock.enter(stage);
+        auto more = input++;
+        clock.leave();
+        if (!more) break;
+        count++;
+        co_yield input.move();
+    }
+}
+
+// counts a pass of a stage and the values it yields
+// note: the stage starts when it is first pulled, a stage that is built but never pulled does not count
+template<class V>
+auto counted(meta::CoEnumerator<V> stage, unsigned& runs, uint64_t& values) -> meta::CoEnumerator<V> {
+    runs++;
+    while (stage++) {
+        values++;
+        co_yield stage.move();
+    }
+}
+
+auto countBlocks(const BlockLiteral& block) -> uint64_t {
+    auto count = uint64_t{1};
+    for (const auto& line : block.value.lines) {
+        for (const auto& token : line.tokens) {
+            token.visitSome([&](const BlockLiteral& nested) { count += countBlocks(nested); });
+        }
+    }
+    return count;
+}
+
+auto lastLine(const BlockLiteral& block) -> uint32_t {
+    auto last = block.position.line.v;
+    for (const auto& line : block.value.lines) {
+        for (const auto& token : line.tokens) {
+            token.visit(
+                [&](const BlockLiteral& nested) { last = std::max(last, lastLine(nested)); },
+                [&](const auto& other) { last = std::max(last, other.position.line.v); });
+        }
+    }
+    return last;
+}
+
+auto countNodes(const parser::Nodes& nodes) -> uint64_t;
+auto countNodes(const parser::Node& node) -> uint64_t {
+    return 1 +
+        node.visit(
+            [](const parser::Block& block) { return countNodes(block.nodes); },
+            [](const parser::Call& call) {
+                auto count = uint64_t{};
+                for (const auto& assign : call.arguments) count += countNodes(assign.values);
+                return count;
+            },
+            [](const parser::VariableInit& init) { return countNodes(init.nodes); },
+            [](const auto&) { return uint64_t{}; });
+}
+auto countNodes(const parser::Nodes& nodes) -> uint64_t {
+    auto count = uint64_t{};
+    for (const auto& node : nodes) count += countNodes(node);
+    return count;
+}
+
+/// blocks of a file and what the pure stages observed
+struct FrontEnd {
+    BlockLiteral blocks{};
+    std::string tokenDump{}; // written in file order by the compiling thread
+    StageRuns runs{};
+    CompileStats stats{}; // stages and counters of the file
+};
+
+// decodes, tokenizes, filters and nests one file, does not touch the compiler
+// note: measures with its own clock, allocations are only tracked if it runs on the compiling thread
+auto runFrontEnd(const TextFile& file, const Config& config, bool collectStats, AllocationTracker* allocations)
+    -> FrontEnd {
+    auto result = FrontEnd{};
+    auto& stats = result.stats;
+    auto clock = StageClock{stats, allocations};
+    auto* stageClock = collectStats ? &clock : nullptr;
+    auto measure = [&](auto input, Stage stage, uint64_t& count) {
+        if (!stageClock) return input;
+        return measured(std::move(input), *stageClock, stage, count);
+    };
+    auto positionCount = uint64_t{}; // note: same as the code points
+    auto& runs = result.runs;
+    auto decode = [&] {
+        stats.bytes = file.content.byteCount().v;
+        auto codePoints = measure(strings::utf8Decode(file.content), Stage::decode, stats.codePoints);
+        return counted(std::move(codePoints), runs.decode, runs.decoded);
+    };
+    auto positions = [&] {
+        auto positioned = measure(text::decodePosition(decode(), config), Stage::positions, positionCount);
+        return counted(std::move(positioned), runs.positions, runs.positioned);
+    };
+    auto tokenize = [&] {
+        auto tokens = measure(scanner::tokenize(positions()), Stage::tokenize, stats.tokens);
+        return counted(std::move(tokens), runs.tokenize, runs.tokenized);
+    };
+    auto blockify = [&](auto tokens) {
+        auto lines = measure(filter::filterTokens(std::move(tokens)), Stage::filter, stats.lines);
+        auto timing = StageScope{stageClock, Stage::nest};
+        runs.nest++;
+        return nesting::nestTokens(counted(std::move(lines), runs.filter, runs.filtered));
+    };
+
+    // note: the pipeline runs once, the token dump observes the tokens while they pass
+    if (!config.tokenOutput) {
+        result.blocks = blockify(tokenize());
+        return result;
+    }
+    auto out = std::ostringstream{};
+    out << "\nTokens:\n";
+    result.blocks = blockify(meta::coTap(tokenize(), [&out](const scanner::Token& t) { out << t << '\n'; }));
+    result.tokenDump = out.str();
+    return result;
+}
+
+// runs the front ends of all files on worker threads, the calling thread takes part
+auto runFrontEnds(
+    const std::vector<const TextFile*>& files, const Config& config, bool collectStats, AllocationTracker* allocations)
+    -> std::vector<FrontEnd> {
+    auto results = std::vector<FrontEnd>(files.size());
+    if (files.empty()) return results;
+    auto workerCount = config.frontEndWorkers != 0 ? config.frontEndWorkers : std::thread::hardware_concurrency();
+    workerCount = std::clamp(workerCount, 1u, static_cast<unsigned>(files.size()));
+    // note: other threads are not tracked, their blocks would be freed here and drive the live bytes negative
+    if (allocations) workerCount = 1;
+
+    auto next = std::atomic<size_t>{};
+    auto work = [&](AllocationTracker* tracker) {
+        for (auto i = next++; i < files.size(); i = next++) {
+            results[i] = runFrontEnd(*files[i], config, collectStats, tracker);
+        }
+    };
+    auto threads = std::vector<std::thread>{};
+    for (auto w = 1u; w < workerCount; w++) threads.emplace_back(work, nullptr);
+    work(allocations);
+    for (auto& thread : threads) thread.join();
+    return results;
+}
+
+// note: the elapsed time of the pure stages sums up the time of all threads
+void addFrontEnd(CompileStats& stats, StageRuns& runs, const FrontEnd& frontEnd) {
+    for (auto i = size_t{}; i < stageCount; i++) stats.elapsed[i] += frontEnd.stats.elapsed[i];
+    stats.bytes += frontEnd.stats.bytes;
+    stats.codePoints += frontEnd.stats.codePoints;
+    stats.tokens += frontEnd.stats.tokens;
+    stats.lines += frontEnd.stats.lines;
+    runs.decode += frontEnd.runs.decode;
+    runs.positions += frontEnd.runs.positions;
+    runs.tokenize += frontEnd.runs.tokenize;
+    runs.filter += frontEnd.runs.filter;
+    runs.nest += frontEnd.runs.nest;
+    runs.decoded += frontEnd.runs.decoded;
+    runs.positioned += frontEnd.runs.positioned;
+    runs.tokenized += frontEnd.runs.tokenized;
+    runs.filtered += frontEnd.runs.filtered;
+}
+
 } // namespace
 
+auto Compiler::stage(Stage stage) -> StageScope { return StageScope{t_bodyWorker ? nullptr : stageClock, stage}; }
+
+// note: workers are not traced
+auto Compiler::traceBlock(const BlockLiteral& block) -> execution::TraceSpan {
+    if (!trace || t_bodyWorker) return {};
+    auto lines = std::to_string(block.position.line.v) + '-' + std::to_string(lastLine(block));
+    trace->begin("parse", "block", {{"lines", lines}});
+    return execution::TraceSpan{trace};
+}
+
 auto Compiler::executionContext(InstanceScope& parserScope) {
     auto r = ExecutionContext{};
-    r.compiler = &compilerCallback;
+    r.compiler = t_bodyWorker ? t_bodyWorker->callback : &compilerCallback;
     r.parserScope = &parserScope;
     auto parse = [&](const BlockLiteral& blockLiteral, auto& parserContext) {
         return parser::Parser::parse(blockLiteral, parserContext);
@@ -107,24 +299,190 @@ auto Compiler::executionContext(InstanceScope& parserScope) {
 }
 
 auto Compiler::parserContext(InstanceScope& scope) {
-    auto lookup = [&](const StringView& id) { return scope[id]; };
-    auto runCall = [&](const Call& call) -> OptNode {
+    auto lookup = [&](const StringView& id) {
+        if (stageClock && !t_bodyWorker) stats.lookups++;
+        return scope[id];
+    };
+    auto runCall = [&](Call call) -> OptNode {
         // TODO(arBmind):
         // * check arguments - have to be available
-        auto callCopy = call;
-        assignResultStorage(callCopy);
+        if (t_bodyWorker) {
+            if (!runsOnWorker(*call.function)) {
+                *t_bodyWorker->serial = true;
+                return {};
+            }
+            assignResultStorage(call);
+            auto heap = meta::ArenaScope{nullptr}; // values created by the execution outlive the parse
+            execution::Machine::runCall(call, executionContext(scope)); // note: the VM caches are not synchronised
+            return extractResults(call, globals);
+        }
+        parsePendingBody(call.function);
+
+        auto memoHash = execution::CallMemo::hashCall(call);
+        if (memoHash) {
+            if (auto* result = callMemo.lookup(call, memoHash.value()); result) return *result;
+        }
 
-        execution::Machine::runCall(callCopy, executionContext(scope));
+        // note: the parser moves the call here, result storage is added to this instance
+        assignResultStorage(call);
 
-        return extractResults(callCopy, globals);
+        auto heap = meta::ArenaScope{nullptr}; // values created by the execution outlive the parse
+        {
+            auto timing = stage(Stage::execute);
+            execution::VM::runCall(call, executionContext(scope));
+        }
+
+        auto result = extractResults(call, globals);
+        // note: a call without an extracted result cannot be skipped, a hit would lose the values it wrote
+        // note: the memo copies the call to the heap, the parsed call dies with its arena
+        if (memoHash && result && !compilerCallback.aborted) callMemo.store(Call{call}, memoHash.value(), result);
+        return result;
     };
     auto reportDiagnostic = [this](Diagnostic diagnostic) {
         // TODO(arBmind): somehow add fileName
-        diagnostics.emplace_back(std::move(diagnostic));
+        this->reportDiagnostic(std::move(diagnostic));
     };
     return parser::Context{std::move(lookup), std::move(runCall), IntrinsicType{&globals}, std::move(reportDiagnostic)};
 }
 
+void Compiler::reportDiagnostic(Diagnostic diagnostic) {
+    if (t_bodyWorker) {
+        t_bodyWorker->diagnostics->emplace_back(std::move(diagnostic));
+    }
+    else {
+        auto timing = stage(Stage::diagnostics);
+        diagnostics.emplace_back(std::move(diagnostic));
+    }
+}
+
+// collects the functions the parser would not run on a worker, modules are searched as well
+void Compiler::addSideEffectNames(instance::LocalScope& locals) {
+    for (auto& named : locals) {
+        auto& entry = named.second;
+        if (entry.holds<instance::Function>() && !runsOnWorker(entry.get<instance::Function>()))
+            sideEffectNames.add(entry.get<instance::Function>().name);
+        if (entry.holds<instance::Module>()) addSideEffectNames(entry.get<instance::Module>().locals);
+    }
+}
+
+// side effects of a deferred body would run after the top level code, such bodies are parsed in source order
+// note: checks the names of the body, a call of a function that is declared later still falls back to the main thread
+bool Compiler::mentionsSideEffects(const BlockLiteral& block) const {
+    auto mentioned = false;
+    auto check = [&](StringView name) { mentioned = sideEffectNames.contains(name); };
+    auto visitBlock = [&](const BlockLiteral& literal, auto& recurse) -> void {
+        for (const auto& line : literal.value.lines) {
+            for (const auto& token : line.tokens) {
+                if (mentioned) return;
+                token.visit(
+                    [&](const BlockLiteral& nested) { recurse(nested, recurse); },
+                    [&](const nesting::IdentifierLiteral& id) { check(id.input); },
+                    [&](const nesting::OperatorLiteral& op) { check(op.input); },
+                    [](const auto&) {});
+            }
+        }
+    };
+    visitBlock(block, visitBlock);
+    return mentioned;
+}
+
+void Compiler::parseFunctionBody(const BlockLiteral& block, instance::Function& function, InstanceScope* scope) {
+    if (config.parallelBodies && !t_bodyWorker) sideEffectNames.add(function.name); // note: the body is unknown yet
+    if (!config.parallelBodies || scope != &globalScope || t_bodyWorker || mentionsSideEffects(block)) {
+        execution::parseFunctionBodyNow(compilerCallback.parseBlock, block, function, scope);
+        return;
+    }
+    auto& deferred = *deferredBodies.emplace_back(std::make_unique<DeferredBody>());
+    deferred.block = block;
+    deferred.function = &function;
+    deferred.parameterScope = InstanceScope(scope);
+    deferred.parameterScope.locals = std::move(function.parameterScope);
+    pendingBodies[&function] = &deferred;
+}
+
+// a call needs the body of the function
+void Compiler::parsePendingBody(instance::FunctionView function) {
+    auto it = pendingBodies.find(function);
+    if (it == pendingBodies.end()) return;
+    auto& deferred = *it->second;
+    pendingBodies.erase(it); // note: recursive calls see the empty body, same as without deferring
+    parseBody(deferred);
+    commitBody(deferred);
+}
+
+void Compiler::parseBody(DeferredBody& deferred) {
+    deferred.arena = execution::makeBodyArena(deferred.block); // note: body and locals are empty
+    auto arenaScope = meta::ArenaScope{deferred.arena.get()};
+    auto bodyScope = InstanceScope(&deferred.parameterScope);
+    deferred.body = compilerCallback.parseBlock(deferred.block, &bodyScope);
+    deferred.locals = std::move(bodyScope.locals);
+}
+
+void Compiler::commitBody(DeferredBody& deferred) {
+    auto& function = *deferred.function;
+    function.body.block = std::move(deferred.body);
+    function.body.locals = std::move(deferred.locals);
+    function.body.arena = std::move(deferred.arena); // note: after the nodes of the previous body are gone
+    function.parameterScope = std::move(deferred.parameterScope.locals);
+    execution::prepareBody(function);
+    for (auto& diagnostic : deferred.diagnostics) diagnostics.emplace_back(std::move(diagnostic));
+    callMemo.invalidate(function); // recursive calls might have seen the empty body
+}
+
+// parses the remaining bodies in parallel against the complete global scope
+// * each body allocates nodes from its own arena, each worker has its own stack
+// * lookups only fill the caches of the scopes of the worker
+// * workers are not profiled, bodies parsed again on the main thread are
+// * results are committed in declaration order
+// * bodies that need anything but pure intrinsic calls are parsed again on the main thread
+void Compiler::parseDeferredBodies() {
+    auto pending = std::vector<DeferredBody*>{};
+    for (auto& deferred : deferredBodies) {
+        if (pendingBodies.count(deferred->function) != 0) pending.push_back(deferred.get());
+    }
+    if (!pending.empty()) {
+        auto workerCount = config.bodyWorkers != 0 ? config.bodyWorkers : std::thread::hardware_concurrency();
+        workerCount = std::clamp(workerCount, 1u, static_cast<unsigned>(pending.size()));
+
+        auto next = std::atomic<size_t>{};
+        auto work = [&] {
+            auto callback = CompilerCallback{};
+            callback.stack = execution::Stack{config.stackSegmentSize, config.stackLimit};
+            callback.callDepthLimit = config.callDepthLimit;
+            callback.stepLimit = config.stepBudget;
+            callback.stepBudgetExhausted = config.stepBudgetExhausted;
+            callback.parseBlock = compilerCallback.parseBlock;
+            callback.reportDiagnostic = [this](Diagnostic diagnostic) { reportDiagnostic(std::move(diagnostic)); };
+            for (auto i = next++; i < pending.size(); i = next++) {
+                auto& deferred = *pending[i];
+                auto worker = BodyWorker{&callback, &deferred.diagnostics, &deferred.serial};
+                t_bodyWorker = &worker;
+                parseBody(deferred);
+                t_bodyWorker = nullptr;
+            }
+        };
+        auto threads = std::vector<std::thread>{};
+        for (auto w = 1u; w < workerCount; w++) threads.emplace_back(work);
+        work();
+        for (auto& thread : threads) thread.join();
+
+        for (auto* deferred : pending) {
+            if (deferred->serial) continue;
+            pendingBodies.erase(deferred->function);
+            commitBody(*deferred);
+        }
+        for (auto* deferred : pending) {
+            if (!deferred->serial) continue;
+            deferred->body = {};
+            deferred->locals = {};
+            deferred->diagnostics.clear();
+            parsePendingBody(deferred->function);
+        }
+    }
+    pendingBodies.clear();
+    deferredBodies.clear();
+}
+
 Compiler::Compiler(Config config, InstanceScope _globals)
     : config(config)
     , globals(std::move(_globals))
@@ -132,42 +490,118 @@ Compiler::Compiler(Config config, InstanceScope _globals)
 
     globals.emplace(intrinsicAdapter::Adapter::moduleInstance<intrinsic::Rebuild>());
 
+    compilerCallback.stack = execution::Stack{config.stackSegmentSize, config.stackLimit};
+    compilerCallback.callDepthLimit = config.callDepthLimit;
+    compilerCallback.stepBudgetExhausted = config.stepBudgetExhausted;
     compilerCallback.parseBlock = [this](const BlockLiteral& block, InstanceScope* scope) -> parser::Block {
+        auto timing = stage(Stage::parse);
+        auto span = traceBlock(block);
         return parser::Parser::parse(block, parserContext(*scope));
     };
-    compilerCallback.reportDiagnostic = [this](Diagnostic diagnostic) {
-        diagnostics.emplace_back(std::move(diagnostic));
+    compilerCallback.parseFunctionBody = [this](const BlockLiteral& block, auto& function, InstanceScope* scope) {
+        parseFunctionBody(block, function, scope);
     };
+    compilerCallback.reportDiagnostic = [this](Diagnostic diagnostic) { reportDiagnostic(std::move(diagnostic)); };
+    compilerCallback.functionDeclared = [this](const instance::Function& function) { callMemo.invalidate(function); };
+    if (config.parallelBodies) addSideEffectNames(globals.locals);
+}
+
+void Compiler::compile(const TextFile& file) { compileFiles({&file}); }
+
+void Compiler::compileAll(const TextFiles& files) {
+    auto refs = TextFileRefs{};
+    refs.reserve(files.size());
+    for (const auto& file : files) refs.push_back(&file);
+    compileFiles(refs);
 }
 
-void Compiler::compile(const TextFile& file) {
-    auto decode = [&](const auto& file) { return strings::utf8Decode(file.content); };
-    auto positions = [&](const auto& file) { return text::decodePosition(decode(file), config); };
-    auto tokenize = [&](const auto& file) { return scanner::tokenize(positions(file)); };
-    auto filter = [&](const auto& file) { return filter::filterTokens(tokenize(file)); };
-    auto blockify = [&](const auto& file) { return nesting::nestTokens(filter(file)); };
-    auto parse = [&](const auto& file) { return parser::Parser::parse(blockify(file), parserContext(globalScope)); };
+void Compiler::compileFiles(const TextFileRefs& files) {
+    compilerCallback.aborted = false;
+    compilerCallback.steps = 0;
+    compilerCallback.stepLimit = config.stepBudget;
+    auto profiler = execution::Profiler{};
+    if (config.profileOutput) compilerCallback.profiler = &profiler;
+    auto traceEvents = std::optional<execution::Trace>{};
+    if (config.traceOutput) trace = compilerCallback.trace = &traceEvents.emplace(*config.traceOutput);
+    runs = {};
+    stats = {};
+    auto allocations = std::optional<AllocationTracker>{};
+    if (config.trackAllocations) allocations.emplace(stats);
+    auto clock = StageClock{stats, allocations ? &*allocations : nullptr};
+    stageClock = config.collectStats || config.statsOutput || config.trackAllocations ? &clock : nullptr;
 
-    if (config.tokenOutput) {
-        auto& out = *config.tokenOutput;
-        out << "\nTokens:\n";
-        for (auto t : tokenize(file)) out << t << '\n';
+    auto frontEnds = [&] {
+        if (trace) trace->begin("compile", "frontEnd", {{"files", std::to_string(files.size())}});
+        auto span = execution::TraceSpan{trace};
+        return runFrontEnds(files, config, stageClock != nullptr, allocations ? &*allocations : nullptr);
+    }();
+    for (const auto& frontEnd : frontEnds) addFrontEnd(stats, runs, frontEnd);
+
+    auto parse = [&](const auto& blocks, meta::Arena& arena) {
+        runs.parse++;
+        auto timing = stage(Stage::parse);
+        auto span = traceBlock(blocks);
+        auto arenaScope = meta::ArenaScope{&arena}; // note: compile time calls run on the heap
+        return parser::Parser::parse(blocks, parserContext(globalScope));
+    };
+    // note: parse and execution of a file see the declarations of all files before it
+    for (auto i = size_t{}; i < files.size(); i++) {
+        const auto& frontEnd = frontEnds[i];
+        if (config.tokenOutput) *config.tokenOutput << frontEnd.tokenDump;
+        if (config.blockOutput) {
+            auto& out = *config.blockOutput;
+            out << "\nBlocks:\n" << frontEnd.blocks;
+        }
+        if (trace) {
+            const auto& name = files[i]->filename;
+            trace->begin("compile", "file", {{"name", std::string(name.begin(), name.end())}});
+        }
+        auto span = execution::TraceSpan{trace};
+
+        auto arena = meta::Arena{}; // nodes of the top level block, released with the file
+        auto block = parse(frontEnd.blocks, arena);
+        {
+            auto timing = stage(Stage::parse);
+            parseDeferredBodies();
+        }
+        execution::resolveSlots(block);
+        if (diagnostics.empty()) {
+            auto timing = stage(Stage::execute);
+            execution::VM::runBlock(block, executionContext(globals));
+        }
+        if (stageClock) {
+            stats.blocks += countBlocks(frontEnd.blocks);
+            stats.nodes += countNodes(block.nodes);
+        }
     }
-    if (config.blockOutput) {
-        auto& out = *config.blockOutput;
-        out << "\nBlocks:\n" << blockify(file);
+    if (!diagnostics.empty() && config.diagnosticsOutput) {
+        auto timing = stage(Stage::diagnostics);
+        auto& out = *config.diagnosticsOutput;
+        out << diagnostics.size() << " diagnostics:\n";
+        for (auto& d : diagnostics) out << d;
     }
 
-    auto block = parse(file);
-    if (!diagnostics.empty()) {
-        if (config.diagnosticsOutput) {
-            auto& out = *config.diagnosticsOutput;
-            out << diagnostics.size() << " diagnostics:\n";
-            for (auto& d : diagnostics) out << d;
-        }
+    if (config.profileOutput) {
+        auto& out = *config.profileOutput;
+        if (config.profileFoldedStacks)
+            profiler.writeFoldedStacks(out);
+        else
+            profiler.writeReport(out);
+    }
+    compilerCallback.profiler = nullptr;
+    trace = compilerCallback.trace = nullptr; // note: traceEvents completes the JSON
+
+    if (stageClock) {
+        stats.calls = compilerCallback.steps;
+        stageClock = nullptr;
+    }
+    if (config.statsOutput) {
+        auto& out = *config.statsOutput;
+        if (config.statsJson)
+            writeJson(out, stats);
+        else
+            writeTable(out, stats);
     }
-    else
-        execution::Machine::runBlock(block, executionContext(globals));
 }
 
 } // namespace rec
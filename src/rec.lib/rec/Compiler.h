@@ -1,37 +1,138 @@
 #pragma once
+#include "CompileStats.h"
+
 #include "diagnostic/Diagnostic.h"
+#include "execution/CallMemo.h"
 #include "execution/Machine.h"
 #include "instance/Scope.h"
+#include "meta/Arena.h"
 #include "text/File.h"
 #include "text/decodePosition.h"
 
+#include <deque>
+#include <memory>
 #include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace rec {
 
 using TextFile = text::File;
+using TextFiles = std::vector<TextFile>;
 using TextConfig = text::Config;
 using InstanceScope = instance::Scope;
 using CompilerCallback = execution::Compiler;
+using diagnostic::Diagnostic;
 using diagnostic::Diagnostics;
 
 struct Config : TextConfig {
     std::ostream* tokenOutput{};
     std::ostream* blockOutput{};
     std::ostream* diagnosticsOutput{};
+    std::ostream* traceOutput{}; // Chrome trace_event JSON of parsing and compile time execution
+    std::ostream* profileOutput{}; // profile of the compile time execution, written after the compilation
+    bool profileFoldedStacks{}; // writes folded stacks for flamegraph tools instead of the report
+    bool collectStats{}; // measures the stages of the pipeline, implied by statsOutput
+    bool trackAllocations{}; // counts the allocations of each stage, implies collectStats
+    std::ostream* statsOutput{}; // stats of each compile
+    bool statsJson{}; // writes the stats as JSON instead of the table
+    // parse top level function bodies after all declarations on worker threads
+    // note: bodies that mention a function with possible side effects are parsed at their declaration
+    // note: a deferred body also sees the functions declared after it, a body parsed at its declaration does not
+    bool parallelBodies{};
+    unsigned bodyWorkers{}; // 0 uses the hardware concurrency
+    unsigned frontEndWorkers{}; // threads of compileAll for the pure stages, 0 uses the hardware concurrency
+    // note: with trackAllocations the front end runs on the calling thread only, so every allocation is counted
+    // the compile time stack grows by segments up to the limit, beyond it reports an overflow
+    size_t stackSegmentSize{execution::Stack::defaultSegmentSize};
+    size_t stackLimit{execution::Stack::defaultLimit}; // note: each body worker has its own stack
+    size_t callDepthLimit{execution::Compiler::defaultCallDepthLimit}; // nested compile time calls
+    // compile time calls and intrinsics before stepBudgetExhausted is asked, 0 is unlimited
+    // note: each body worker has its own budget and asks from its own thread
+    uint64_t stepBudget{};
+    execution::StepBudgetExhausted stepBudgetExhausted = [](const execution::StepProgress&) -> uint64_t { return 0; };
     // std::ostream* rebuildOutput{}; // TODO(arBmind): allow to configure stdout used by builtin stdout
 };
 
+/// number of times each stage of the pipeline ran in the last compile
+/// note: counted inside the stages, together with the values each lazy stage yielded
+struct StageRuns {
+    unsigned decode{};
+    unsigned positions{};
+    unsigned tokenize{};
+    unsigned filter{};
+    unsigned nest{};
+    unsigned parse{}; // note: only the top level block
+
+    uint64_t decoded{}; // code points
+    uint64_t positioned{}; // note: one per code point
+    uint64_t tokenized{};
+    uint64_t filtered{}; // lines
+};
+
 struct Compiler final {
 private:
+    /// top level function body, that is parsed after all declarations
+    struct DeferredBody {
+        nesting::BlockLiteral block{}; // note: the block argument of declareFunction is a temporary
+        instance::Function* function{};
+        InstanceScope parameterScope; // parent is the global scope
+
+        // result of a parallel parse, committed in declaration order
+        std::shared_ptr<meta::Arena> arena{}; // nodes of body and locals
+        parser::Block body{};
+        instance::LocalScope locals{};
+        Diagnostics diagnostics{};
+        bool serial{}; // body needs side effects and is parsed on the main thread
+    };
+    using DeferredBodies = std::vector<std::unique_ptr<DeferredBody>>;
+    using DeferredBodyByFunction = std::unordered_map<instance::FunctionView, DeferredBody*>;
+
+    /// names of all functions that might have side effects, a body that mentions one is not deferred
+    /// note: names are only added, a function whose body turns out to be pure keeps its name here
+    struct SideEffectNames {
+        std::unordered_set<strings::CompareView> views{}; // note: keys view into names
+        std::deque<instance::Name> names{};
+
+        void add(const instance::Name& name) {
+            if (views.count(strings::CompareView{name}) != 0) return;
+            views.insert(strings::CompareView{names.emplace_back(name)});
+        }
+        bool contains(strings::View name) const { return views.count(strings::CompareView{name}) != 0; }
+    };
+
     Config config;
     InstanceScope globals;
     InstanceScope globalScope;
     CompilerCallback compilerCallback;
+    execution::CallMemo callMemo; // results of pure compile time calls
     Diagnostics diagnostics;
+    DeferredBodies deferredBodies;
+    DeferredBodyByFunction pendingBodies; // deferred bodies that are not parsed yet
+    SideEffectNames sideEffectNames; // note: only filled with parallelBodies
+    StageRuns runs;
+    CompileStats stats;
+    StageClock* stageClock{}; // set while a compile collects stats
+    execution::Trace* trace{}; // set while a compile is traced
+
+    using TextFileRefs = std::vector<const TextFile*>;
 
+    auto stage(Stage stage) -> StageScope;
+    auto traceBlock(const nesting::BlockLiteral& block) -> execution::TraceSpan;
     auto executionContext(InstanceScope& parserScope);
     auto parserContext(InstanceScope& scope);
+    void reportDiagnostic(Diagnostic diagnostic);
+
+    void addSideEffectNames(instance::LocalScope& locals);
+    bool mentionsSideEffects(const nesting::BlockLiteral& block) const;
+    void parseFunctionBody(const nesting::BlockLiteral& block, instance::Function& function, InstanceScope* scope);
+    void parsePendingBody(instance::FunctionView function);
+    void parseDeferredBodies();
+    void parseBody(DeferredBody& deferred);
+    void commitBody(DeferredBody& deferred);
+
+    void compileFiles(const TextFileRefs& files);
 
 public:
     Compiler(Config config, InstanceScope globals = {});
@@ -45,6 +146,16 @@ public:
 
     // run the compiler
     void compile(const TextFile& file);
+
+    // compiles the files in order, as if each was compiled on its own
+    // * the pure stages (decode to nest) of all files run in parallel before the first file is parsed
+    // * diagnostics of all files are written once, in the order of the files
+    void compileAll(const TextFiles& files);
+
+    auto callMemoStats() const -> const execution::CallMemoStats& { return callMemo.stats(); }
+    auto stageRuns() const -> const StageRuns& { return runs; }
+    auto compileStats() const -> const CompileStats& { return stats; } // note: empty without collectStats
+    auto stackStats() const -> const execution::StackStats& { return compilerCallback.stack.stats(); }
 };
 
 } // namespace rec
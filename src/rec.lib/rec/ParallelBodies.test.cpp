@@ -0,0 +1,69 @@
+#include "Compiler.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+using namespace rec;
+
+namespace {
+
+auto source() -> std::string {
+    auto text = std::string{};
+    for (auto i = 0; i < 8; i++) {
+        auto n = std::to_string(i);
+        text += "Rebuild.Context.declareFunction left=() f" + n + " (a :Rebuild.literal.String) ():\n";
+        if (i % 2 == 0) {
+            text += "    Rebuild.say a\n";
+            text += "    Rebuild.say \"parse f" + n + "\"\n"; // side effect while parsing the body
+        }
+        else {
+            text += "    \"body f" + n + "\"\n"; // nothing to run, the body is deferred
+        }
+        text += "end\n";
+    }
+    text += "f3 \"call f3\"\n"; // needs the body before the deferred parse
+    text += "f0 \"call f0\"\n";
+    return text;
+}
+
+auto compileOutput(bool parallelBodies, const std::string& text = source()) -> std::string {
+    auto diagnostics = std::stringstream{};
+    auto config = Config{text::Column{8}};
+    config.diagnosticsOutput = &diagnostics;
+    config.parallelBodies = parallelBodies;
+    config.bodyWorkers = 4;
+    auto compiler = Compiler{config};
+
+    auto file = text::File{strings::String{"TestFile"}, strings::String{text.data(), text.data() + text.size()}};
+    testing::internal::CaptureStdout();
+    compiler.compile(file);
+    return testing::internal::GetCapturedStdout() + diagnostics.str();
+}
+
+} // namespace
+
+TEST(ParallelBodies, sameOutputAsSerial) {
+    auto serial = compileOutput(false);
+    ASSERT_FALSE(serial.empty());
+    EXPECT_EQ(compileOutput(true), serial);
+}
+
+TEST(ParallelBodies, deterministic) {
+    auto first = compileOutput(true);
+    for (auto i = 0; i < 4; i++) EXPECT_EQ(compileOutput(true), first);
+}
+
+// the deferred body of g is parsed after h is declared, without deferring h is unknown in the body of g
+TEST(ParallelBodies, forwardReferences) {
+    auto text = std::string{"Rebuild.Context.declareFunction left=() g (a :Rebuild.literal.String) ():\n"
+                            "    h a\n"
+                            "end\n"
+                            "Rebuild.Context.declareFunction left=() h (a :Rebuild.literal.String) ():\n"
+                            "    Rebuild.say a\n"
+                            "end\n"
+                            "g \"x\"\n"};
+    EXPECT_EQ(compileOutput(false, text), "");
+    EXPECT_EQ(compileOutput(true, text), "x\n");
+}
@@ -0,0 +1,150 @@
+#include "rec/Compiler.h"
+#include "rec/SourceGenerator.h"
+
+#include "filter/filterTokens.h"
+#include "nesting/nestTokens.h"
+#include "scanner/tokenize.h"
+#include "strings/utf8Decode.h"
+#include "text/decodePosition.h"
+
+#include "bench/Benchmark.h"
+
+#include <string>
+#include <vector>
+
+/// each lexer stage runs on the recorded output of the stage before it
+/// all benchmarks report MB/s of the source and ns/item per scanner token
+namespace {
+
+using Generator = std::string (*)(int64_t);
+
+auto textConfig() -> text::Config { return text::Config{text::Column{8}}; }
+
+template<class T>
+auto replay(const std::vector<T>& values) -> meta::CoEnumerator<T> {
+    for (const auto& value : values) co_yield value;
+}
+
+template<class T>
+auto record(meta::CoEnumerator<T> input) -> std::vector<T> {
+    auto values = std::vector<T>{};
+    while (input++) values.push_back(input.move());
+    return values;
+}
+
+template<class T>
+auto drain(meta::CoEnumerator<T> input) -> uint64_t {
+    auto count = uint64_t{};
+    while (input++) {
+        bench::doNotOptimize(*input);
+        count++;
+    }
+    return count;
+}
+
+/// generated source and its recorded stages
+struct Input {
+    std::string source{};
+    text::File file{};
+    uint64_t tokens{};
+
+    Input(Generator generator, int64_t size)
+        : source(generator(size))
+        , file{strings::String{"Bench"}, strings::String{source.data(), source.data() + source.size()}} {
+        tokens = drain(scanner::tokenize(text::decodePosition(strings::utf8Decode(file.content), textConfig())));
+    }
+
+    auto decoded() const { return record(strings::utf8Decode(file.content)); }
+    auto positions() const { return record(text::decodePosition(strings::utf8Decode(file.content), textConfig())); }
+    auto tokenized() const { return record(scanner::tokenize(replay(positions()))); }
+    auto lines() const { return record(filter::filterTokens(replay(tokenized()))); }
+
+    void report(bench::State& state) const {
+        state.setBytesProcessed(state.iterations() * source.size());
+        state.setItemsProcessed(state.iterations() * tokens);
+        state.setCounter("tokens", static_cast<double>(tokens));
+    }
+};
+
+void decodeStage(bench::State& state, Generator generator) {
+    auto input = Input{generator, state.arg()};
+    while (state.keepRunning()) drain(strings::utf8Decode(input.file.content));
+    input.report(state);
+}
+
+void positionsStage(bench::State& state, Generator generator) {
+    auto input = Input{generator, state.arg()};
+    auto decoded = input.decoded();
+    while (state.keepRunning()) drain(text::decodePosition(replay(decoded), textConfig()));
+    input.report(state);
+}
+
+void tokenizeStage(bench::State& state, Generator generator) {
+    auto input = Input{generator, state.arg()};
+    auto positions = input.positions();
+    while (state.keepRunning()) drain(scanner::tokenize(replay(positions)));
+    input.report(state);
+}
+
+void filterStage(bench::State& state, Generator generator) {
+    auto input = Input{generator, state.arg()};
+    auto tokens = input.tokenized();
+    while (state.keepRunning()) drain(filter::filterTokens(replay(tokens)));
+    input.report(state);
+}
+
+void nestStage(bench::State& state, Generator generator) {
+    auto input = Input{generator, state.arg()};
+    auto lines = input.lines();
+    while (state.keepRunning()) bench::doNotOptimize(nesting::nestTokens(replay(lines)));
+    input.report(state);
+}
+
+/// the whole compile, reports the share of each stage of the last compile in percent
+void endToEnd(bench::State& state, Generator generator) {
+    auto input = Input{generator, state.arg()};
+    auto config = rec::Config{text::Column{8}};
+    config.collectStats = true;
+    auto stats = rec::CompileStats{};
+    while (state.keepRunning()) {
+        auto compiler = rec::Compiler{config};
+        compiler.compile(input.file);
+        stats = compiler.compileStats();
+    }
+    input.report(state);
+    auto total = static_cast<double>(stats.total().count());
+    for (auto i = size_t{}; i < rec::stageCount; i++) {
+        auto stage = static_cast<rec::Stage>(i);
+        auto share = total > 0 ? 100.0 * static_cast<double>(stats[stage].count()) / total : 0.0;
+        state.setCounter(std::string{rec::stageName(stage)} + "%", share);
+    }
+}
+
+#define LEXER_BENCHMARKS(input, ...)                                                                                   \
+    void decode_##input(bench::State& state) { decodeStage(state, &rec::generate::input); }                            \
+    void positions_##input(bench::State& state) { positionsStage(state, &rec::generate::input); }                      \
+    void tokenize_##input(bench::State& state) { tokenizeStage(state, &rec::generate::input); }                        \
+    void filter_##input(bench::State& state) { filterStage(state, &rec::generate::input); }                            \
+    void nest_##input(bench::State& state) { nestStage(state, &rec::generate::input); }                                \
+    BENCHMARK(decode_##input, __VA_ARGS__);                                                                            \
+    BENCHMARK(positions_##input, __VA_ARGS__);                                                                         \
+    BENCHMARK(tokenize_##input, __VA_ARGS__);                                                                          \
+    BENCHMARK(filter_##input, __VA_ARGS__);                                                                            \
+    BENCHMARK(nest_##input, __VA_ARGS__)
+
+#define COMPILE_BENCHMARK(input, ...)                                                                                  \
+    void compile_##input(bench::State& state) { endToEnd(state, &rec::generate::input); }                              \
+    BENCHMARK(compile_##input, __VA_ARGS__)
+
+LEXER_BENCHMARKS(flat, 1000, 10000);
+LEXER_BENCHMARKS(nested, 16, 256);
+LEXER_BENCHMARKS(longLines, 1000, 10000);
+LEXER_BENCHMARKS(declarations, 100, 1000);
+LEXER_BENCHMARKS(unicode, 1000, 10000);
+LEXER_BENCHMARKS(literals, 1000, 10000);
+
+COMPILE_BENCHMARK(flat, 1000, 10000);
+COMPILE_BENCHMARK(nested, 16, 256);
+COMPILE_BENCHMARK(declarations, 100, 1000);
+
+} // namespace
@@ -0,0 +1,208 @@
+#include "Compiler.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace rec;
+
+TEST(Pipeline, dumpsRunStagesOnce) {
+    auto tokens = std::stringstream{};
+    auto blocks = std::stringstream{};
+    auto config = Config{text::Column{8}};
+    config.tokenOutput = &tokens;
+    config.blockOutput = &blocks;
+    auto compiler = Compiler{config};
+
+    auto file = text::File{strings::String{"TestFile"}, strings::String{"Rebuild.say \"a\"\nRebuild.say \"b\"\n"}};
+    testing::internal::CaptureStdout();
+    compiler.compile(file);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "a\nb\n");
+
+    const auto& runs = compiler.stageRuns();
+    EXPECT_EQ(runs.decode, 1u);
+    EXPECT_EQ(runs.positions, 1u);
+    EXPECT_EQ(runs.tokenize, 1u);
+    EXPECT_EQ(runs.filter, 1u);
+    EXPECT_EQ(runs.nest, 1u);
+    EXPECT_EQ(runs.parse, 1u);
+
+    // every stage yields its values once, the dump sees each token exactly once
+    EXPECT_EQ(runs.decoded, 32u);
+    EXPECT_EQ(runs.positioned, runs.decoded);
+    EXPECT_GT(runs.tokenized, runs.filtered);
+    EXPECT_GE(runs.filtered, 2u);
+
+    auto dump = tokens.str();
+    EXPECT_EQ(dump.find("\nTokens:\n"), 0u);
+    EXPECT_EQ(dump.find("\nTokens:\n", 1), std::string::npos);
+    auto dumpedTokens = static_cast<uint64_t>(std::count(dump.begin(), dump.end(), '\n')) - 2; // note: header
+    EXPECT_EQ(dumpedTokens, runs.tokenized);
+    EXPECT_NE(blocks.str().find("\nBlocks:\n"), std::string::npos);
+}
+
+TEST(Pipeline, collectStats) {
+    auto config = Config{text::Column{8}};
+    config.collectStats = true;
+    auto compiler = Compiler{config};
+
+    auto file = text::File{strings::String{"TestFile"}, strings::String{"Rebuild.say \"a\"\nRebuild.say \"b\"\n"}};
+    testing::internal::CaptureStdout();
+    compiler.compile(file);
+    testing::internal::GetCapturedStdout();
+
+    const auto& stats = compiler.compileStats();
+    EXPECT_EQ(stats.bytes, 32u);
+    EXPECT_EQ(stats.codePoints, 32u);
+    EXPECT_GT(stats.tokens, stats.lines);
+    EXPECT_GE(stats.lines, 2u);
+    EXPECT_EQ(stats.blocks, 1u);
+    EXPECT_EQ(stats.calls, 2u);
+    EXPECT_GT(stats.lookups, 0u);
+    EXPECT_GT(stats.total(), CompileStats::Duration{});
+}
+
+// note: raise the thresholds consciously, they guard against allocation regressions
+TEST(Pipeline, allocationBudget) {
+    auto config = Config{text::Column{8}};
+    config.trackAllocations = true;
+    auto compiler = Compiler{config};
+
+    auto file = text::File{strings::String{"TestFile"}, strings::String{"Rebuild.say \"a\"\nRebuild.say \"b\"\n"}};
+    testing::internal::CaptureStdout();
+    compiler.compile(file);
+    testing::internal::GetCapturedStdout();
+
+    const auto& stats = compiler.compileStats();
+    ASSERT_TRUE(stats.allocationsTracked);
+    EXPECT_GT(stats.totalAllocations.count, 0u);
+    EXPECT_LT(stats.totalAllocations.count, 10'000u);
+    EXPECT_LT(stats.totalAllocations.peakLive, 1'000'000);
+}
+
+TEST(Pipeline, traceOutput) {
+    auto trace = std::stringstream{};
+    auto config = Config{text::Column{8}};
+    config.traceOutput = &trace;
+    auto compiler = Compiler{config};
+
+    auto file = text::File{strings::String{"TestFile"}, strings::String{"Rebuild.say \"a\"\nRebuild.say \"b\"\n"}};
+    testing::internal::CaptureStdout();
+    compiler.compile(file);
+    testing::internal::GetCapturedStdout();
+
+    auto json = trace.str();
+    EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"cat\":\"compile\",\"name\":\"file\",\"args\":{\"name\":\"TestFile\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"cat\":\"parse\",\"name\":\"block\""), std::string::npos);
+    EXPECT_NE(json.find("\"cat\":\"intrinsic\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"stack\""), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+}
+
+namespace {
+
+auto makeFiles(std::vector<std::string> sources) -> TextFiles {
+    auto files = TextFiles{};
+    for (auto i = 0u; i < sources.size(); i++) {
+        auto name = "File" + std::to_string(i);
+        const auto& text = sources[i];
+        files.push_back(text::File{
+            strings::String{name.data(), name.data() + name.size()},
+            strings::String{text.data(), text.data() + text.size()}});
+    }
+    return files;
+}
+
+auto compileAllOutput(const TextFiles& files, unsigned workers) -> std::string {
+    auto diagnostics = std::stringstream{};
+    auto config = Config{text::Column{8}};
+    config.diagnosticsOutput = &diagnostics;
+    config.frontEndWorkers = workers;
+    auto compiler = Compiler{config};
+
+    testing::internal::CaptureStdout();
+    compiler.compileAll(files);
+    return testing::internal::GetCapturedStdout() + diagnostics.str();
+}
+
+} // namespace
+
+TEST(Pipeline, compileAllInFileOrder) {
+    auto config = Config{text::Column{8}};
+    config.frontEndWorkers = 4;
+    auto compiler = Compiler{config};
+
+    auto files = makeFiles({
+        "Rebuild.Context.declareFunction left=() f (a :Rebuild.literal.String) ():\n    Rebuild.say a\nend\n",
+        "f \"a\"\n", // declared by the file before
+        "Rebuild.say \"b\"\n",
+        "Rebuild.say \"c\"\n",
+        "Rebuild.say \"d\"\n",
+    });
+    testing::internal::CaptureStdout();
+    compiler.compileAll(files);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "a\nb\nc\nd\n");
+
+    const auto& runs = compiler.stageRuns();
+    EXPECT_EQ(runs.decode, 5u);
+    EXPECT_EQ(runs.nest, 5u);
+    EXPECT_EQ(runs.parse, 5u);
+}
+
+// all files are tracked, whichever worker count is configured
+TEST(Pipeline, compileAllTracksAllocationsOfEveryFile) {
+    auto files = TextFiles{};
+    for (auto i = 0; i < 8; i++) files.push_back(makeFiles({"Rebuild.say \"" + std::to_string(i) + "\"\n"}).front());
+    auto tracked = [&](unsigned workers) {
+        auto config = Config{text::Column{8}};
+        config.trackAllocations = true;
+        config.frontEndWorkers = workers;
+        auto compiler = Compiler{config};
+        testing::internal::CaptureStdout();
+        compiler.compileAll(files);
+        testing::internal::GetCapturedStdout();
+        return compiler.compileStats();
+    };
+    auto serial = tracked(1);
+    auto parallel = tracked(4);
+    for (auto stage : {Stage::tokenize, Stage::nest}) {
+        const auto& allocations = parallel.allocations[static_cast<size_t>(stage)];
+        EXPECT_GT(allocations.count, 0u);
+        EXPECT_EQ(allocations.count, serial.allocations[static_cast<size_t>(stage)].count);
+    }
+    EXPECT_EQ(parallel.totalAllocations.count, serial.totalAllocations.count);
+}
+
+TEST(Pipeline, compileAllDiagnosticsInFileOrder) {
+    auto files = makeFiles({
+        "Rebuild.say \"a\"\n",
+        "\x80\n",
+        "Rebuild.say \"b\"\n",
+        "\x07\n",
+    });
+    auto serial = compileAllOutput(files, 1);
+    EXPECT_NE(serial.find("2 diagnostics:\n"), std::string::npos);
+    EXPECT_LT(serial.find("Invalid UTF8 Encoding"), serial.find("Unexpected characters"));
+    for (auto i = 0; i < 4; i++) EXPECT_EQ(compileAllOutput(files, 4), serial);
+}
+
+TEST(Pipeline, userFunctionsRunEveryCall) {
+    auto compiler = Compiler{Config{text::Column{8}}};
+
+    // note: say with a literal would run once while the body is parsed, the parameter defers it to the call
+    auto file = text::File{
+        strings::String{"TestFile"},
+        strings::String{"Rebuild.Context.declareFunction left=() f (a :Rebuild.literal.String) ():\n"
+                        "    Rebuild.say a\n"
+                        "end\n"
+                        "f \"f\"\n"
+                        "f \"f\"\n"}};
+    testing::internal::CaptureStdout();
+    compiler.compile(file);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "f\nf\n");
+    EXPECT_EQ(compiler.callMemoStats().hits, 0u);
+}
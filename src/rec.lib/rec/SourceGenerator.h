@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/// deterministic synthetic Rebuild sources for benchmarks
+///
+/// * the same arguments always generate the same source
+/// * flat, nested, declarations and unit are valid programs that do not print
+/// * the other sources only stress the lexer, they are not valid programs
+namespace rec {
+namespace generate {
+
+/// many independent top level statements
+inline auto flat(int64_t lines) -> std::string {
+    auto source = std::string{};
+    for (auto i = int64_t{}; i < lines; i++) {
+        auto n = std::to_string(i);
+        source += "Rebuild.Context.declareVariable v" + n + " :Rebuild.literal.String = \"Value " + n + "\"\n";
+    }
+    return source;
+}
+
+/// modules nested into each other up to the depth
+inline auto nested(int64_t depth) -> std::string {
+    auto source = std::string{};
+    for (auto i = int64_t{}; i < depth; i++) {
+        auto indent = std::string(static_cast<size_t>(i) * 4, ' ');
+        source += indent + "Rebuild.Context.declareModule m" + std::to_string(i) + ":\n";
+    }
+    source += std::string(static_cast<size_t>(depth) * 4, ' ');
+    source += "Rebuild.Context.declareVariable v :Rebuild.literal.String = \"Deep\"\n";
+    for (auto i = depth; i > 0; i--) source += std::string(static_cast<size_t>(i - 1) * 4, ' ') + "end\n";
+    return source;
+}
+
+/// few lines with many tokens each
+inline auto longLines(int64_t tokensPerLine) -> std::string {
+    auto source = std::string{};
+    for (auto line = 0; line < 16; line++) {
+        for (auto i = int64_t{}; i < tokensPerLine; i++) {
+            source += i % 2 == 0 ? "name" + std::to_string(i) : std::string{"+"};
+            source += ' ';
+        }
+        source += '\n';
+    }
+    return source;
+}
+
+/// functions and modules with bodies, nothing is executed at runtime
+inline auto declarations(int64_t count) -> std::string {
+    auto source = std::string{};
+    for (auto i = int64_t{}; i < count; i++) {
+        auto n = std::to_string(i);
+        source += "Rebuild.Context.declareVariable v" + n + " :Rebuild.literal.String = \"Value " + n + "\"\n";
+        source += "Rebuild.Context.declareFunction left=() f" + n + " (a :Rebuild.literal.String) ():\n";
+        source += "    Rebuild.say a\n";
+        source += "    Rebuild.say \"Function " + n + "\"\n";
+        source += "end\n";
+        if (i % 8 == 0) {
+            source += "Rebuild.Context.declareModule module" + n + ":\n";
+            source += "    Rebuild.Context.declareVariable m" + n + " :Rebuild.literal.String = \"Module " + n + "\"\n";
+            source += "end\n";
+        }
+    }
+    return source;
+}
+
+/// one file of a program with many files, the names do not collide with other indices
+inline auto unit(int64_t index, int64_t count) -> std::string {
+    auto source = std::string{};
+    for (auto i = int64_t{}; i < count; i++) {
+        auto n = "u" + std::to_string(index) + "_" + std::to_string(i);
+        source += "Rebuild.Context.declareVariable v" + n + " :Rebuild.literal.String = \"Value " + n + "\"\n";
+        source += "Rebuild.Context.declareFunction left=() f" + n + " (a :Rebuild.literal.String) ():\n";
+        source += "    Rebuild.say a\n";
+        source += "end\n";
+    }
+    return source;
+}
+
+/// identifiers and operators outside of ascii
+inline auto unicode(int64_t lines) -> std::string {
+    const char* identifiers[] = {"größe", "变量", "переменная", "λ", "𝔸𝔹", "名前"};
+    const char* operators[] = {"→", "≤", "∘", "⊕", "≠", "∀"};
+    auto source = std::string{};
+    for (auto i = int64_t{}; i < lines; i++) {
+        auto n = std::to_string(i);
+        source += identifiers[i % 6] + n + ' ' + operators[i % 6] + ' ' + identifiers[(i + 1) % 6] + n + ' ';
+        source += operators[(i + 3) % 6] + std::string{" \"τέλος "} + n + "\"\n";
+    }
+    return source;
+}
+
+/// numbers and strings in many notations
+inline auto literals(int64_t lines) -> std::string {
+    auto source = std::string{};
+    for (auto i = int64_t{}; i < lines; i++) {
+        auto n = std::to_string(i);
+        source += "values" + n + " = [" + n + ", " + n + ".25, 0x" + std::to_string(i % 4096) + "F, 0b101, 1'000'" + n;
+        source += ", \"text " + n + "\", \"escaped \\\"" + n + "\\\"\"]\n";
+    }
+    return source;
+}
+
+} // namespace generate
+} // namespace rec